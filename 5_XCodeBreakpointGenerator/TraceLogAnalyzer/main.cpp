@@ -0,0 +1,290 @@
+//
+//  main.cpp
+//  TraceLogAnalyzer
+//
+//  Created by Hendrik von Prince on 21/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// reads the debugger-console-output of a program that was traced with breakpoints generated by
+// XCodeBreakpointGenerator --timestamps, rebuilds the call-tree of every thread and reports the
+// inclusive and exclusive time spent in each method
+// the log is processed line by line, so it doesn't matter how long the trace is: memory only grows
+// with the number of distinct methods and call-stacks
+//
+// the lines we are interested in look like
+//   XBG timebase 125/3
+//   XBG 81238712 1799     entering method -[FirstViewController viewDidLoad] ...
+//   XBG 81239977 1799     returning from method -[FirstViewController viewDidLoad] (line 42)
+// everything in front of the XBG-prefix (like the timestamp of the console) is ignored
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string tracePrefix = "XBG ";
+const std::string timebaseMarker = "timebase ";
+const std::string enteringMarker = "entering method ";
+const std::string returningMarker = "returning from method ";
+
+struct Frame {
+  std::string method;
+  unsigned long long startTicks;
+  unsigned long long childTicks;
+};
+
+struct ThreadState {
+  std::vector<Frame> stack;
+  std::map<std::string, unsigned> activeCalls; // used to not count the inclusive time of recursive calls twice
+  unsigned long long lastTicks;
+};
+
+struct MethodStatistics {
+  unsigned long long calls;
+  unsigned long long inclusiveTicks;
+  unsigned long long exclusiveTicks;
+};
+
+class TraceAnalyzer {
+  unsigned long long timebaseNumer;
+  unsigned long long timebaseDenom;
+  bool timebaseFixed;
+
+  std::map<unsigned long long, ThreadState> threads;
+  std::map<std::string, MethodStatistics> statistics;
+  std::map<std::string, unsigned long long> foldedStacks;
+
+  unsigned long long ignoredReturns;
+  unsigned long long unfinishedCalls;
+
+  static std::string methodName(const std::string &text) {
+    // method-declarations look like -[Class selector:], selectors can't contain a ]
+    auto end = text.find(']');
+    if ((text.compare(0, 2, "-[") == 0 || text.compare(0, 2, "+[") == 0) && end != std::string::npos) {
+      return text.substr(0, end + 1);
+    }
+    return text.substr(0, text.find(' '));
+  }
+
+  std::string stackName(const ThreadState &thread) const {
+    std::string result;
+    for (auto &frame : thread.stack) {
+      if (!result.empty()) {
+        result += ";";
+      }
+      result += frame.method;
+    }
+    return result;
+  }
+
+  void popFrame(ThreadState &thread, unsigned long long ticks) {
+    auto &frame = thread.stack.back();
+    auto inclusive = ticks >= frame.startTicks ? ticks - frame.startTicks : 0;
+    auto exclusive = inclusive >= frame.childTicks ? inclusive - frame.childTicks : 0;
+
+    auto &methodStatistics = this->statistics[frame.method];
+    ++methodStatistics.calls;
+    methodStatistics.exclusiveTicks += exclusive;
+    if (--thread.activeCalls[frame.method] == 0) {
+      methodStatistics.inclusiveTicks += inclusive;
+    }
+
+    this->foldedStacks[stackName(thread)] += exclusive;
+
+    thread.stack.pop_back();
+    if (!thread.stack.empty()) {
+      thread.stack.back().childTicks += inclusive;
+    }
+  }
+
+  void enter(ThreadState &thread, const std::string &method, unsigned long long ticks) {
+    Frame frame;
+    frame.method = method;
+    frame.startTicks = ticks;
+    frame.childTicks = 0;
+    thread.stack.push_back(frame);
+    ++thread.activeCalls[method];
+  }
+
+  void leave(ThreadState &thread, const std::string &method, unsigned long long ticks) {
+    auto frame = std::find_if(thread.stack.rbegin(), thread.stack.rend(), [&method](const Frame &frame) { return frame.method == method; });
+    if (frame == thread.stack.rend()) {
+      // the call started before the trace did
+      ++this->ignoredReturns;
+      return;
+    }
+    // frames above the returning one missed their return (e.g. because of an exception), they end here too
+    auto framesToPop = std::distance(thread.stack.rbegin(), frame) + 1;
+    for (auto i = 0; i < framesToPop; ++i) {
+      popFrame(thread, ticks);
+    }
+  }
+
+  double ticksToMicroseconds(unsigned long long ticks) const { return (double)ticks * this->timebaseNumer / this->timebaseDenom / 1000.0; }
+
+public:
+  TraceAnalyzer() : timebaseNumer(1), timebaseDenom(1), timebaseFixed(false), ignoredReturns(0), unfinishedCalls(0) {}
+
+  void setTimebase(unsigned long long numer, unsigned long long denom) {
+    this->timebaseNumer = numer;
+    this->timebaseDenom = denom;
+    this->timebaseFixed = true;
+  }
+
+  void processLine(const std::string &line) {
+    auto prefixPosition = line.find(tracePrefix);
+    if (prefixPosition == std::string::npos) {
+      return;
+    }
+    auto content = line.substr(prefixPosition + tracePrefix.size());
+
+    if (content.compare(0, timebaseMarker.size(), timebaseMarker) == 0) {
+      unsigned long long numer = 0, denom = 0;
+      char separator = 0;
+      std::istringstream timebase(content.substr(timebaseMarker.size()));
+      if (!this->timebaseFixed && (timebase >> numer >> separator >> denom) && separator == '/' && numer > 0 && denom > 0) {
+        this->timebaseNumer = numer;
+        this->timebaseDenom = denom;
+      }
+      return;
+    }
+
+    unsigned long long ticks = 0, threadID = 0;
+    std::istringstream header(content);
+    if (!(header >> ticks >> threadID)) {
+      return;
+    }
+
+    auto &thread = this->threads[threadID];
+    thread.lastTicks = ticks;
+
+    auto entering = content.find(enteringMarker);
+    auto returning = content.find(returningMarker);
+    if (entering != std::string::npos && (returning == std::string::npos || entering < returning)) {
+      enter(thread, methodName(content.substr(entering + enteringMarker.size())), ticks);
+    } else if (returning != std::string::npos) {
+      leave(thread, methodName(content.substr(returning + returningMarker.size())), ticks);
+    }
+  }
+
+  // closes the calls that didn't return until the end of the trace
+  void finish() {
+    for (auto &thread : this->threads) {
+      while (!thread.second.stack.empty()) {
+        ++this->unfinishedCalls;
+        popFrame(thread.second, thread.second.lastTicks);
+      }
+    }
+  }
+
+  void printTable(std::ostream &output, const std::string &sortKey) const {
+    std::vector<std::pair<std::string, MethodStatistics>> rows(this->statistics.begin(), this->statistics.end());
+    std::sort(rows.begin(), rows.end(), [&sortKey](const std::pair<std::string, MethodStatistics> &a, const std::pair<std::string, MethodStatistics> &b) {
+      if (sortKey == "exclusive") {
+        return a.second.exclusiveTicks > b.second.exclusiveTicks;
+      } else if (sortKey == "calls") {
+        return a.second.calls > b.second.calls;
+      }
+      return a.second.inclusiveTicks > b.second.inclusiveTicks;
+    });
+
+    output << std::setw(10) << "calls" << std::setw(16) << "inclusive (us)" << std::setw(16) << "exclusive (us)" << std::setw(14) << "avg incl (us)"
+           << "  method" << std::endl;
+    output << std::fixed << std::setprecision(1);
+    for (auto &row : rows) {
+      auto inclusive = ticksToMicroseconds(row.second.inclusiveTicks);
+      output << std::setw(10) << row.second.calls << std::setw(16) << inclusive << std::setw(16) << ticksToMicroseconds(row.second.exclusiveTicks)
+             << std::setw(14) << (row.second.calls ? inclusive / row.second.calls : 0.0) << "  " << row.first << std::endl;
+    }
+
+    if (this->ignoredReturns) {
+      output << this->ignoredReturns << " returns without a matching entry were ignored" << std::endl;
+    }
+    if (this->unfinishedCalls) {
+      output << this->unfinishedCalls << " calls didn't return until the end of the trace" << std::endl;
+    }
+  }
+
+  // one line per call-stack with its exclusive time in microseconds, as expected by flamegraph.pl
+  void printFoldedStacks(std::ostream &output) const {
+    for (auto &stack : this->foldedStacks) {
+      auto microseconds = (unsigned long long)(ticksToMicroseconds(stack.second) + 0.5);
+      if (microseconds > 0) {
+        output << stack.first << " " << microseconds << std::endl;
+      }
+    }
+  }
+};
+
+void printUsage(const char *programName) {
+  std::cerr << "usage: " << programName << " [--folded <file>] [--sort inclusive|exclusive|calls] [--timebase <numer>/<denom>] [logfile]" << std::endl
+            << "reads from stdin if no logfile is given" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  TraceAnalyzer analyzer;
+  std::string foldedPath;
+  std::string sortKey = "inclusive";
+  std::string logPath;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--folded" && i + 1 < argc) {
+      foldedPath = argv[++i];
+    } else if (argument == "--sort" && i + 1 < argc) {
+      sortKey = argv[++i];
+    } else if (argument == "--timebase" && i + 1 < argc) {
+      unsigned long long numer = 0, denom = 0;
+      if (std::sscanf(argv[++i], "%llu/%llu", &numer, &denom) != 2 || numer == 0 || denom == 0) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      analyzer.setTimebase(numer, denom);
+    } else if (argument == "--help" || argument == "-h" || (!argument.empty() && argument[0] == '-') || !logPath.empty()) {
+      printUsage(argv[0]);
+      return argument == "--help" || argument == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else {
+      logPath = argument;
+    }
+  }
+
+  std::ifstream logFile;
+  if (!logPath.empty()) {
+    logFile.open(logPath);
+    if (!logFile) {
+      std::cerr << "could not open " << logPath << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::istream &input = logPath.empty() ? std::cin : logFile;
+
+  std::string line;
+  while (std::getline(input, line)) {
+    analyzer.processLine(line);
+  }
+  analyzer.finish();
+
+  analyzer.printTable(std::cout, sortKey);
+
+  if (!foldedPath.empty()) {
+    std::ofstream foldedFile(foldedPath);
+    if (!foldedFile) {
+      std::cerr << "could not write " << foldedPath << std::endl;
+      return EXIT_FAILURE;
+    }
+    analyzer.printFoldedStacks(foldedFile);
+  }
+
+  return EXIT_SUCCESS;
+}
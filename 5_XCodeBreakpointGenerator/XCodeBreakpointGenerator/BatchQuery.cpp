@@ -0,0 +1,120 @@
+//
+//  BatchQuery.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 22/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "BatchQuery.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/Dynamic/Diagnostics.h"
+#include "clang/ASTMatchers/Dynamic/Parser.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/StringRef.h"
+
+using namespace clang;
+using namespace ast_matchers;
+
+namespace {
+
+// like clang-query, the matcher is bound to "root"
+llvm::Optional<internal::DynTypedMatcher> parseQuery(llvm::StringRef expression, dynamic::Diagnostics *diagnostics) {
+  auto matcher = dynamic::Parser::parseMatcherExpression(expression, diagnostics);
+  if (!matcher) {
+    return matcher;
+  }
+  auto boundMatcher = matcher->tryBind("root");
+  return boundMatcher ? boundMatcher : matcher;
+}
+
+} // namespace
+
+void BatchQuery::QueryCallback::run(const MatchFinder::MatchResult &Result) {
+  auto &sourceManager = Result.Context->getSourceManager();
+
+  auto &boundNodes = Result.Nodes.getMap();
+  auto rootNode = boundNodes.find("root");
+  if (rootNode == boundNodes.end()) {
+    return;
+  }
+
+  auto location = sourceManager.getExpansionLoc(rootNode->second.getSourceRange().getBegin());
+  std::stringstream match;
+  if (location.isValid()) {
+    match << sourceManager.getFilename(location).str() << ":" << sourceManager.getExpansionLineNumber(location) << ":"
+          << sourceManager.getExpansionColumnNumber(location) << ": ";
+  }
+  match << rootNode->second.getNodeKind().asStringRef().str();
+
+  std::lock_guard<std::mutex> lock(this->batchQuery.matchesMutex);
+  this->batchQuery.queries[this->queryIndex].matches.insert(match.str());
+}
+
+bool BatchQuery::parseQueryFile(const std::string &filePath) {
+  std::ifstream queryFile(filePath);
+  if (!queryFile) {
+    std::cerr << "could not read the query-file " << filePath << std::endl;
+    return false;
+  }
+
+  bool success = true;
+  std::string line;
+  for (unsigned lineNumber = 1; std::getline(queryFile, line); ++lineNumber) {
+    auto expression = llvm::StringRef(line).trim();
+    if (expression.empty() || expression.startswith("#") || expression.startswith("set ")) {
+      continue;
+    }
+    if (expression.startswith("match ")) {
+      expression = expression.drop_front(6).ltrim();
+    } else if (expression.startswith("m ")) {
+      expression = expression.drop_front(2).ltrim();
+    }
+
+    dynamic::Diagnostics diagnostics;
+    if (!parseQuery(expression, &diagnostics)) {
+      std::cerr << filePath << ":" << lineNumber << ": invalid query: " << diagnostics.toStringFull() << std::endl;
+      success = false;
+      continue;
+    }
+
+    this->queries.push_back(Query(lineNumber, expression.str()));
+    this->callbacks.push_back(std::unique_ptr<QueryCallback>(new QueryCallback(*this, this->queries.size() - 1)));
+  }
+
+  if (success && this->queries.empty()) {
+    std::cerr << "the query-file " << filePath << " doesn't contain any query" << std::endl;
+    return false;
+  }
+  return success;
+}
+
+void BatchQuery::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath) {
+  // every thread has its own MatchFinder and its own matchers, the expressions were checked when the file was read
+  for (size_t queryIndex = 0; queryIndex < this->queries.size(); ++queryIndex) {
+    dynamic::Diagnostics diagnostics;
+    auto matcher = parseQuery(this->queries[queryIndex].expression, &diagnostics);
+    finder.addDynamicMatcher(*matcher, this->callbacks[queryIndex].get());
+  }
+}
+
+int BatchQuery::finish(std::ostream &report) {
+  printResults(report);
+  return 0;
+}
+
+void BatchQuery::printResults(std::ostream &output) const {
+  for (size_t queryIndex = 0; queryIndex < this->queries.size(); ++queryIndex) {
+    auto &query = this->queries[queryIndex];
+    output << "query " << queryIndex + 1 << " (line " << query.lineNumber << "): " << query.expression << ": " << query.matches.size()
+           << (query.matches.size() == 1 ? " match" : " matches") << std::endl;
+    for (auto &match : query.matches) {
+      output << "  " << match << std::endl;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+//
+//  BatchQuery.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 22/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// runs many clang-query-expressions over the compilation-database at once
+// all expressions are registered on the same MatchFinder, so every file is parsed exactly once no matter how many queries there are
+// the expressions are checked once when the file is read, but parsed again for every MatchFinder: the reference-counts of the matchers are
+// not atomic, so they can't be shared between the threads
+
+#ifndef __XCodeBreakpointGenerator__BatchQuery__
+#define __XCodeBreakpointGenerator__BatchQuery__
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+#include "PassManager.h"
+
+class BatchQuery : public Pass {
+  struct Query {
+    unsigned lineNumber;
+    std::string expression;
+    std::set<std::string> matches; // a match within a header is reported once, even if it is matched in multiple files
+
+    Query(unsigned lineNumber, const std::string &expression) : lineNumber(lineNumber), expression(expression) {}
+  };
+
+  class QueryCallback : public clang::ast_matchers::MatchFinder::MatchCallback {
+    BatchQuery &batchQuery;
+    size_t queryIndex;
+
+  public:
+    QueryCallback(BatchQuery &batchQuery, size_t queryIndex) : batchQuery(batchQuery), queryIndex(queryIndex) {}
+    virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result);
+  };
+
+  std::vector<Query> queries;
+  std::vector<std::unique_ptr<QueryCallback>> callbacks; // one for every query, they only differ in the index of the query
+  std::mutex matchesMutex;
+
+public:
+  // reads a file with one query per line, using the syntax of clang-query:
+  //   match objcInterface(isInMainFile())
+  // lines starting with # are comments, set-commands are ignored
+  // returns false if the file can't be read or if one of the expressions is invalid
+  bool parseQueryFile(const std::string &filePath);
+
+  virtual const char *getName() const override { return "queries"; }
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) override;
+  virtual int finish(std::ostream &report) override;
+
+  void printResults(std::ostream &output) const;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__BatchQuery__) */
@@ -75,6 +75,14 @@ void BreakPoint::setLandmarkName(decltype(landmarkName) landmarkName) {
   this->landmarkName= landmarkName;
 }
 
+decltype(BreakPoint::landmarkName) BreakPoint::getLandmarkName() const {
+  return this->landmarkName;
+}
+
+decltype(BreakPoint::id) BreakPoint::getID() const {
+  return this->id;
+}
+
 
 std::string BreakPoint::asXML() {
   std::string result;
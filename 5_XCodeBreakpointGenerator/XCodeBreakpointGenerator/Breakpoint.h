@@ -53,6 +53,8 @@ public:
   decltype(BreakPoint::sourceRange) getSourceRange() const;
   void setSourceRange(const FullSourceRange &range);
   void setLandmarkName(decltype(landmarkName) landmarkName);
+  decltype(BreakPoint::landmarkName) getLandmarkName() const;
+  decltype(BreakPoint::id) getID() const;
   std::string asXML();
   bool operator<(const BreakPoint &breakpoint) const;
 };
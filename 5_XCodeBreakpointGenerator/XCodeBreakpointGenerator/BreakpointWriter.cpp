@@ -0,0 +1,39 @@
+//
+//  BreakpointWriter.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "BreakpointWriter.h"
+
+BreakpointWriter::BreakpointWriter(std::ostream &output, bool deferOutput) : output(output), deferOutput(deferOutput) {}
+
+void BreakpointWriter::write(BreakPoint &breakpoint, bool mayBeDeferred) {
+  std::lock_guard<std::mutex> lock(this->outputMutex);
+  if (!this->writtenBreakpointIDs.insert(breakpoint.getID()).second) {
+    return;
+  }
+  if (this->deferOutput && mayBeDeferred) {
+    this->deferredBreakpoints[breakpoint.getLandmarkName()].push_back(breakpoint.asXML());
+  } else {
+    this->output << breakpoint.asXML() << std::endl;
+  }
+}
+
+unsigned long BreakpointWriter::writeDeferredBreakpoints(const std::set<std::string> &methods) {
+  std::lock_guard<std::mutex> lock(this->outputMutex);
+  unsigned long writtenMethods = 0;
+  for (auto &method : methods) {
+    auto deferred = this->deferredBreakpoints.find(method);
+    if (deferred == this->deferredBreakpoints.end()) {
+      continue;
+    }
+    ++writtenMethods;
+    for (auto &xml : deferred->second) {
+      this->output << xml << std::endl;
+    }
+  }
+  return writtenMethods;
+}
@@ -0,0 +1,44 @@
+//
+//  BreakpointWriter.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// the single output of all passes, breakpoints can be written from multiple threads at once
+// only the IDs of the breakpoints that were written are kept to filter out duplicates, not the breakpoints themselves
+
+#ifndef __XCodeBreakpointGenerator__BreakpointWriter__
+#define __XCodeBreakpointGenerator__BreakpointWriter__
+
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Breakpoint.h"
+
+class BreakpointWriter {
+  std::ostream &output;
+  std::set<std::string> writtenBreakpointIDs;
+  std::mutex outputMutex;
+
+  // when the breakpoints are restricted to a call-graph, they can't be written until the whole compilation-database was matched
+  // thus they are held back, grouped by the method they belong to
+  bool deferOutput;
+  std::map<std::string, std::vector<std::string>> deferredBreakpoints;
+
+public:
+  BreakpointWriter(std::ostream &output, bool deferOutput = false);
+
+  // breakpoints that don't belong to a method, like the one in the main-method, are never held back
+  void write(BreakPoint &breakpoint, bool mayBeDeferred = true);
+
+  // writes the held back breakpoints of the given methods and returns the number of methods that had breakpoints
+  unsigned long writeDeferredBreakpoints(const std::set<std::string> &methods);
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__BreakpointWriter__) */
@@ -0,0 +1,139 @@
+//
+//  CallGraph.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 20/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "CallGraph.h"
+
+#include <deque>
+#include <tuple>
+
+bool CallTarget::operator<(const CallTarget &target) const {
+  return std::tie(this->isFunction, this->isClassMethod, this->className, this->name) <
+         std::tie(target.isFunction, target.isClassMethod, target.className, target.name);
+}
+
+std::string CallGraph::methodDeclaration(bool isClassMethod, const std::string &className, const std::string &selector) {
+  return std::string(isClassMethod ? "+" : "-") + "[" + className + " " + selector + "]";
+}
+
+void CallGraph::addMethod(bool isClassMethod, const std::string &className, const std::string &selector) {
+  Node node;
+  node.isFunction = false;
+  node.isClassMethod = isClassMethod;
+  node.className = className;
+  node.name = selector;
+  this->nodes[methodDeclaration(isClassMethod, className, selector)] = node;
+}
+
+void CallGraph::addFunction(const std::string &name) {
+  Node node;
+  node.isFunction = true;
+  node.isClassMethod = false;
+  node.name = name;
+  this->nodes[name] = node;
+}
+
+void CallGraph::setSuperClass(const std::string &className, const std::string &superClassName) { this->superClasses[className] = superClassName; }
+
+void CallGraph::addCall(const std::string &caller, const CallTarget &callee) { this->calls[caller].insert(callee); }
+
+bool CallGraph::isSubclassOf(std::string className, const std::string &superClassName) const {
+  // the depth is limited to guard against broken hierarchies
+  for (int depth = 0; depth < 64; ++depth) {
+    if (className == superClassName) {
+      return true;
+    }
+    auto superClass = this->superClasses.find(className);
+    if (superClass == this->superClasses.end()) {
+      return false;
+    }
+    className = superClass->second;
+  }
+  return false;
+}
+
+std::vector<std::string> CallGraph::resolve(const CallTarget &target) const {
+  std::vector<std::string> result;
+
+  if (target.isFunction) {
+    if (this->nodes.count(target.name)) {
+      result.push_back(target.name);
+    }
+    return result;
+  }
+
+  // the message may be dispatched to the class itself or to any of its subclasses overriding the method
+  for (auto &node : this->nodes) {
+    if (node.second.isFunction || node.second.isClassMethod != target.isClassMethod || node.second.name != target.name) {
+      continue;
+    }
+    if (target.className.empty() || isSubclassOf(node.second.className, target.className)) {
+      result.push_back(node.first);
+    }
+  }
+
+  // if the class doesn't implement the method by itself, it may be inherited
+  if (!target.className.empty()) {
+    auto className = target.className;
+    for (int depth = 0; depth < 64 && !this->nodes.count(methodDeclaration(target.isClassMethod, className, target.name)); ++depth) {
+      auto superClass = this->superClasses.find(className);
+      if (superClass == this->superClasses.end()) {
+        break;
+      }
+      className = superClass->second;
+    }
+    auto inherited = methodDeclaration(target.isClassMethod, className, target.name);
+    if (className != target.className && this->nodes.count(inherited)) {
+      result.push_back(inherited);
+    }
+  }
+
+  return result;
+}
+
+std::set<std::string> CallGraph::reachableFrom(const std::string &root, int maxDepth) const {
+  std::set<std::string> reachable;
+  std::deque<std::pair<std::string, int>> queue;
+
+  if (this->nodes.count(root)) {
+    queue.push_back(std::make_pair(root, 0));
+  } else {
+    // the root is a bare selector, start at every method implementing it
+    for (auto &node : this->nodes) {
+      if (!node.second.isFunction && node.second.name == root) {
+        queue.push_back(std::make_pair(node.first, 0));
+      }
+    }
+  }
+
+  // breadth-first, so every method is reached with the least possible depth
+  while (!queue.empty()) {
+    auto current = queue.front();
+    queue.pop_front();
+
+    if (!reachable.insert(current.first).second) {
+      continue;
+    }
+    if (maxDepth >= 0 && current.second >= maxDepth) {
+      continue;
+    }
+
+    auto callees = this->calls.find(current.first);
+    if (callees == this->calls.end()) {
+      continue;
+    }
+    for (auto &callee : callees->second) {
+      for (auto &resolved : resolve(callee)) {
+        if (!reachable.count(resolved)) {
+          queue.push_back(std::make_pair(resolved, current.second + 1));
+        }
+      }
+    }
+  }
+
+  return reachable;
+}
@@ -0,0 +1,61 @@
+//
+//  CallGraph.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 20/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// a static call-graph over all methods and functions that were seen while matching the compilation-database
+// like Breakpoint.h, this is not related to clang-processing, the nodes are filled in by main.cpp
+
+#ifndef __XCodeBreakpointGenerator__CallGraph__
+#define __XCodeBreakpointGenerator__CallGraph__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// the target of a call, as far as it could be resolved statically
+// for messages where the class of the receiver is unknown (id, protocols), className is empty
+// and every method with a matching selector is treated as a possible callee
+struct CallTarget {
+  bool isFunction;
+  bool isClassMethod;
+  std::string className;
+  std::string name; // the selector for methods, the name for functions
+
+  bool operator<(const CallTarget &target) const;
+};
+
+class CallGraph {
+  struct Node {
+    bool isFunction;
+    bool isClassMethod;
+    std::string className;
+    std::string name;
+  };
+
+  // key is the method-declaration as it is used as landmark-name, e.g. -[FirstViewController viewDidLoad]
+  std::map<std::string, Node> nodes;
+  std::map<std::string, std::set<CallTarget>> calls;
+  std::map<std::string, std::string> superClasses;
+
+  bool isSubclassOf(std::string className, const std::string &superClassName) const;
+  std::vector<std::string> resolve(const CallTarget &target) const;
+
+public:
+  static std::string methodDeclaration(bool isClassMethod, const std::string &className, const std::string &selector);
+
+  void addMethod(bool isClassMethod, const std::string &className, const std::string &selector);
+  void addFunction(const std::string &name);
+  void setSuperClass(const std::string &className, const std::string &superClassName);
+  void addCall(const std::string &caller, const CallTarget &callee);
+
+  // root is either a full method-declaration (-[Foo bar:]), a bare selector (bar:) or a function-name
+  // a negative maxDepth means that the depth is unlimited
+  std::set<std::string> reachableFrom(const std::string &root, int maxDepth) const;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__CallGraph__) */
@@ -0,0 +1,104 @@
+//
+//  CallGraphPass.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "CallGraphPass.h"
+
+#include <ostream>
+
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+
+using namespace clang;
+using namespace ast_matchers;
+
+namespace {
+
+class CallCollector : public RecursiveASTVisitor<CallCollector> {
+  CallGraph &callGraph;
+  std::string caller;
+
+public:
+  CallCollector(CallGraph &callGraph, const std::string &caller) : callGraph(callGraph), caller(caller) {}
+
+  bool VisitObjCMessageExpr(const ObjCMessageExpr *messageExpr) {
+    CallTarget callee;
+    callee.isFunction = false;
+    // messages to an instance typed as Class are class-messages too, the method-declaration knows about it
+    callee.isClassMethod = messageExpr->getMethodDecl() ? messageExpr->getMethodDecl()->isClassMethod() : messageExpr->isClassMessage();
+    if (auto receiverInterface = messageExpr->getReceiverInterface()) {
+      callee.className = receiverInterface->getNameAsString();
+    }
+    callee.name = messageExpr->getSelector().getAsString();
+
+    this->callGraph.addCall(this->caller, callee);
+    return true;
+  }
+
+  bool VisitCallExpr(const CallExpr *callExpr) {
+    if (auto function = callExpr->getDirectCallee()) {
+      CallTarget callee;
+      callee.isFunction = true;
+      callee.isClassMethod = false;
+      callee.name = function->getQualifiedNameAsString();
+
+      this->callGraph.addCall(this->caller, callee);
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+CallGraphPass::CallGraphPass(BreakpointWriter &writer, const std::string &rootMethod, int maxCallDepth)
+    : writer(writer), rootMethod(rootMethod), maxCallDepth(maxCallDepth) {}
+
+void CallGraphPass::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath) {
+  // the call-graph needs all methods, a filtered method may still call one that passes
+  finder.addMatcher(objcMethod(isDefinition(), isInMainFile()).bind("method"), this);
+  finder.addMatcher(functionDecl(isDefinition(), isInMainFile()).bind("function"), this);
+}
+
+void CallGraphPass::run(const MatchFinder::MatchResult &Result) {
+  std::lock_guard<std::mutex> lock(this->callGraphMutex);
+  std::string caller;
+  Stmt *body = nullptr;
+
+  if (auto method = Result.Nodes.getDeclAs<ObjCMethodDecl>("method")) {
+    auto classInterface = method->getClassInterface();
+    if (!classInterface) {
+      return;
+    }
+    auto className = classInterface->getNameAsString();
+    if (auto superClass = classInterface->getSuperClass()) {
+      this->callGraph.setSuperClass(className, superClass->getNameAsString());
+    }
+    this->callGraph.addMethod(method->isClassMethod(), className, method->getSelector().getAsString());
+    caller = CallGraph::methodDeclaration(method->isClassMethod(), className, method->getSelector().getAsString());
+    body = method->getBody();
+  } else if (auto function = Result.Nodes.getDeclAs<FunctionDecl>("function")) {
+    caller = function->getQualifiedNameAsString();
+    this->callGraph.addFunction(caller);
+    body = function->getBody();
+  }
+
+  if (body) {
+    CallCollector collector(this->callGraph, caller);
+    collector.TraverseStmt(body);
+  }
+}
+
+int CallGraphPass::finish(std::ostream &report) {
+  auto reachableMethods = this->callGraph.reachableFrom(this->rootMethod, this->maxCallDepth);
+  if (reachableMethods.empty()) {
+    report << "could not find the method " << this->rootMethod << " within the compilation-database - no breakpoints were generated" << std::endl;
+    return 1;
+  }
+  auto writtenMethods = this->writer.writeDeferredBreakpoints(reachableMethods);
+  report << "generated breakpoints for " << writtenMethods << " methods reachable from " << this->rootMethod << std::endl;
+  return 0;
+}
@@ -0,0 +1,46 @@
+//
+//  CallGraphPass.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// collects the calls of every method and function into a CallGraph
+// the calls are taken from the ObjCMessageExpr- and CallExpr-nodes within the bodies, so they are resolved statically:
+// messages to id or to protocols are assumed to reach every method with a matching selector
+// a method can be reached through files that are not traced, so the calls are collected from every file of the compilation-database
+// when all files were processed, only the held back breakpoints of the methods that are reachable from the root are written
+
+#ifndef __XCodeBreakpointGenerator__CallGraphPass__
+#define __XCodeBreakpointGenerator__CallGraphPass__
+
+#include <mutex>
+#include <string>
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+#include "BreakpointWriter.h"
+#include "CallGraph.h"
+#include "PassManager.h"
+
+class CallGraphPass : public Pass, public clang::ast_matchers::MatchFinder::MatchCallback {
+  CallGraph callGraph;
+  std::mutex callGraphMutex;
+
+  BreakpointWriter &writer;
+  std::string rootMethod;
+  int maxCallDepth;
+
+public:
+  // the writer has to hold back the breakpoints until finish is called
+  CallGraphPass(BreakpointWriter &writer, const std::string &rootMethod, int maxCallDepth);
+
+  virtual const char *getName() const override { return "call-graph"; }
+  virtual bool needsUnrequestedFile(const std::string &sourceFilePath) const override { return true; }
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) override;
+  virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
+  virtual int finish(std::ostream &report) override;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__CallGraphPass__) */
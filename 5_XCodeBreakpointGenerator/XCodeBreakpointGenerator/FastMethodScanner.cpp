@@ -0,0 +1,355 @@
+//
+//  FastMethodScanner.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 24/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "FastMethodScanner.h"
+#include "SharedFileSystem.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringRef.h"
+
+using namespace clang;
+
+namespace {
+
+// the raw tokens of a file and everything that is needed to get their spelling and location
+class TokenStream {
+  std::vector<Token> tokens;
+  SourceManager &sourceManager;
+  const LangOptions &langOptions;
+  std::string filePath;
+
+public:
+  TokenStream(SourceManager &sourceManager, const LangOptions &langOptions, const std::string &filePath)
+      : sourceManager(sourceManager), langOptions(langOptions), filePath(filePath) {}
+
+  void push_back(const Token &token) { this->tokens.push_back(token); }
+  size_t size() const { return this->tokens.size(); }
+
+  bool is(size_t index, tok::TokenKind kind) const { return index < this->tokens.size() && this->tokens[index].is(kind); }
+
+  bool isIdentifier(size_t index) const { return is(index, tok::raw_identifier); }
+
+  bool isIdentifier(size_t index, llvm::StringRef name) const { return isIdentifier(index) && spelling(index) == name; }
+
+  std::string spelling(size_t index) const { return Lexer::getSpelling(this->tokens[index], this->sourceManager, this->langOptions); }
+
+  // the spellings of the tokens between startIndex and endIndex (exclusive), separated by spaces
+  std::string spelling(size_t startIndex, size_t endIndex) const {
+    std::string result;
+    for (auto index = startIndex; index < endIndex && index < this->tokens.size(); ++index) {
+      result += (result.empty() ? "" : " ") + spelling(index);
+    }
+    return result;
+  }
+
+  FullSourceRange sourceRange(size_t startIndex, size_t endIndex) const {
+    FullSourceRange sourceRange;
+    sourceRange.filePath = this->filePath;
+    sourceRange.startingLineNumber = this->sourceManager.getSpellingLineNumber(this->tokens[startIndex].getLocation());
+    sourceRange.startingColumnNumber = this->sourceManager.getSpellingColumnNumber(this->tokens[startIndex].getLocation());
+    sourceRange.endingLineNumber = this->sourceManager.getSpellingLineNumber(this->tokens[endIndex].getLocation());
+    sourceRange.endingColumnNumber = this->sourceManager.getSpellingColumnNumber(this->tokens[endIndex].getLocation());
+    return sourceRange;
+  }
+
+  // returns the index of the token that closes the bracket at index, or size() if it isn't closed
+  size_t skipBalanced(size_t index) const {
+    int depth = 0;
+    for (; index < this->tokens.size(); ++index) {
+      if (is(index, tok::l_paren) || is(index, tok::l_brace) || is(index, tok::l_square)) {
+        ++depth;
+      } else if (is(index, tok::r_paren) || is(index, tok::r_brace) || is(index, tok::r_square)) {
+        if (--depth == 0) {
+          return index;
+        }
+      }
+    }
+    return this->tokens.size();
+  }
+};
+
+// identifiers like SYNTHESIZE_SINGLETON or RETURN_IF_NIL are most likely macros, we can't know what they expand to
+// the well-known ones from the SDK don't contain any statements, so they don't hurt
+bool looksLikeMacro(const std::string &identifier) {
+  if (identifier == "MIN" || identifier == "MAX" || identifier == "ABS") {
+    return false;
+  }
+  return identifier.size() > 1 && std::none_of(identifier.begin(), identifier.end(), [](char c) { return std::islower(c); }) &&
+         std::any_of(identifier.begin(), identifier.end(), [](char c) { return std::isupper(c); });
+}
+
+class Scanner {
+  const TokenStream &tokens;
+  std::vector<ScannedMethod> &methods;
+  std::string &reasonForFallback;
+
+  bool fail(const std::string &reason) {
+    this->reasonForFallback = reason;
+    return false;
+  }
+
+  // parses the method-header starting at the +/- at index, index points to the { of the body afterwards
+  bool scanMethodHeader(size_t &index, const std::string &className, ScannedMethod &method) {
+    bool isClassMethod = this->tokens.is(index, tok::plus);
+    ++index;
+    if (this->tokens.is(index, tok::l_paren)) {
+      index = this->tokens.skipBalanced(index) + 1;
+    }
+    if (!this->tokens.isIdentifier(index)) {
+      return fail("unexpected token in method-declaration");
+    }
+
+    std::string selector = this->tokens.spelling(index++);
+    if (this->tokens.is(index, tok::colon)) {
+      // keyword-selector: [keyword]:(type)parameter ...
+      std::string keyword = selector;
+      selector.clear();
+      while (true) {
+        selector += keyword + ":";
+        ++index;
+        std::string parameterType;
+        if (this->tokens.is(index, tok::l_paren)) {
+          auto typeEnd = this->tokens.skipBalanced(index);
+          parameterType = this->tokens.spelling(index + 1, typeEnd);
+          index = typeEnd + 1;
+        }
+        if (!this->tokens.isIdentifier(index)) {
+          return fail("unexpected token in method-declaration");
+        }
+        method.parameterNames.push_back(this->tokens.spelling(index++));
+        method.parameterTypes.push_back(parameterType);
+
+        if (this->tokens.isIdentifier(index) && this->tokens.is(index + 1, tok::colon)) {
+          keyword = this->tokens.spelling(index++);
+        } else if (this->tokens.is(index, tok::colon)) {
+          keyword.clear();
+        } else if (this->tokens.is(index, tok::comma) && this->tokens.is(index + 1, tok::ellipsis)) {
+          index += 2;
+          break;
+        } else {
+          break;
+        }
+      }
+    }
+
+    if (!this->tokens.is(index, tok::l_brace)) {
+      // attributes or macros between the declaration and the body
+      return fail("unexpected token in front of the body of " + selector);
+    }
+
+    method.methodDeclaration = std::string(isClassMethod ? "+" : "-") + "[" + className + " " + selector + "]";
+    method.className = className;
+    method.selector = selector;
+    return true;
+  }
+
+  // scans the body starting at the { at index, index points to the matching } afterwards
+  bool scanMethodBody(size_t &index, ScannedMethod &method) {
+    auto bodyStart = index;
+    auto bodyEnd = this->tokens.skipBalanced(index);
+    if (bodyEnd >= this->tokens.size()) {
+      return fail("unbalanced braces in " + method.methodDeclaration);
+    }
+    method.bodyRange = this->tokens.sourceRange(bodyStart, bodyEnd);
+
+    for (index = bodyStart + 1; index < bodyEnd; ++index) {
+      if (!this->tokens.isIdentifier(index)) {
+        continue;
+      }
+      auto identifier = this->tokens.spelling(index);
+      if (looksLikeMacro(identifier) && this->tokens.is(index + 1, tok::l_paren)) {
+        return fail("call of the macro " + identifier + " in " + method.methodDeclaration);
+      }
+      // a macro that is used as a statement, like RETURN_NIL; may contain a return-statement the lexer doesn't see
+      // the return-statements the lexer does see are written within the file, so the --location-policy never applies to them
+      auto isStatementStart = this->tokens.is(index - 1, tok::semi) || this->tokens.is(index - 1, tok::l_brace) ||
+                              this->tokens.is(index - 1, tok::r_brace) || this->tokens.is(index - 1, tok::r_paren) ||
+                              this->tokens.isIdentifier(index - 1, "else") || this->tokens.isIdentifier(index - 1, "do");
+      if (looksLikeMacro(identifier) && isStatementStart && this->tokens.is(index + 1, tok::semi)) {
+        return fail("use of the macro " + identifier + " as statement in " + method.methodDeclaration);
+      }
+      if (identifier != "return") {
+        continue;
+      }
+
+      // the statement ends with the first ; that is not nested in brackets, e.g. within a block
+      auto returnStart = index;
+      auto returnEnd = index;
+      int depth = 0;
+      for (++index; index < bodyEnd && !(depth == 0 && this->tokens.is(index, tok::semi)); ++index) {
+        if (this->tokens.is(index, tok::l_paren) || this->tokens.is(index, tok::l_brace) || this->tokens.is(index, tok::l_square)) {
+          ++depth;
+        } else if (this->tokens.is(index, tok::r_paren) || this->tokens.is(index, tok::r_brace) || this->tokens.is(index, tok::r_square)) {
+          --depth;
+        }
+        returnEnd = index;
+      }
+      if (index >= bodyEnd) {
+        return fail("unterminated return-statement in " + method.methodDeclaration);
+      }
+
+      ScannedReturn scannedReturn;
+      scannedReturn.sourceRange = this->tokens.sourceRange(returnStart, returnEnd);
+      // without Sema, only parameters and self are known to be variables
+      if (returnEnd == returnStart + 1 && this->tokens.isIdentifier(returnEnd)) {
+        auto returnValue = this->tokens.spelling(returnEnd);
+        if (returnValue == "self" ||
+            std::find(method.parameterNames.begin(), method.parameterNames.end(), returnValue) != method.parameterNames.end()) {
+          scannedReturn.returnValue = returnValue;
+        }
+      }
+      method.returns.push_back(scannedReturn);
+    }
+
+    index = bodyEnd;
+    return true;
+  }
+
+  // scans an @implementation-block, index points to the identifier implementation and to the identifier end afterwards
+  bool scanImplementation(size_t &index) {
+    ++index;
+    if (!this->tokens.isIdentifier(index)) {
+      return fail("unexpected token after @implementation");
+    }
+    auto className = this->tokens.spelling(index++);
+
+    // category or superclass
+    if (this->tokens.is(index, tok::l_paren)) {
+      index = this->tokens.skipBalanced(index) + 1;
+    } else if (this->tokens.is(index, tok::colon) && this->tokens.isIdentifier(index + 1)) {
+      index += 2;
+    }
+    // instance-variables
+    if (this->tokens.is(index, tok::l_brace)) {
+      index = this->tokens.skipBalanced(index) + 1;
+    }
+
+    while (index < this->tokens.size()) {
+      if (this->tokens.is(index, tok::at) && this->tokens.isIdentifier(index + 1, "end")) {
+        ++index;
+        return true;
+      }
+      if (this->tokens.is(index, tok::at) && this->tokens.isIdentifier(index + 1, "implementation")) {
+        return fail("@implementation without @end");
+      }
+
+      if (this->tokens.is(index, tok::minus) || this->tokens.is(index, tok::plus)) {
+        ScannedMethod method;
+        if (!scanMethodHeader(index, className, method)) {
+          return false;
+        }
+        if (!scanMethodBody(index, method)) {
+          return false;
+        }
+        this->methods.push_back(method);
+      } else if (this->tokens.is(index, tok::l_brace)) {
+        // the body of a function within the @implementation, no breakpoints are generated for functions
+        index = this->tokens.skipBalanced(index);
+      } else if (this->tokens.isIdentifier(index) && looksLikeMacro(this->tokens.spelling(index)) && this->tokens.is(index + 1, tok::l_paren)) {
+        return fail("use of the macro " + this->tokens.spelling(index) + " within @implementation " + className);
+      }
+      ++index;
+    }
+
+    return fail("@implementation " + className + " without @end");
+  }
+
+public:
+  Scanner(const TokenStream &tokens, std::vector<ScannedMethod> &methods, std::string &reasonForFallback)
+      : tokens(tokens), methods(methods), reasonForFallback(reasonForFallback) {}
+
+  bool scan() {
+    for (size_t index = 0; index < this->tokens.size(); ++index) {
+      if (this->tokens.is(index, tok::at) && this->tokens.isIdentifier(index + 1, "implementation")) {
+        ++index;
+        if (!scanImplementation(index)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+FastMethodScanner::FastMethodScanner(SharedFileSystem *sharedFileSystem) : sharedFileSystem(sharedFileSystem) {}
+
+bool FastMethodScanner::scanFile(const std::string &filePath, std::vector<ScannedMethod> &methods, std::string &reasonForFallback) {
+  auto absolutePath = tooling::getAbsolutePath(filePath);
+
+  IntrusiveRefCntPtr<DiagnosticIDs> diagnosticIDs(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticOptions> diagnosticOptions(new DiagnosticOptions());
+  DiagnosticsEngine diagnostics(diagnosticIDs, &*diagnosticOptions, new IgnoringDiagConsumer());
+  IntrusiveRefCntPtr<FileManager> files;
+  if (this->sharedFileSystem) {
+    files = this->sharedFileSystem->getFileManager(std::string());
+  } else {
+    files = new FileManager(FileSystemOptions());
+  }
+  SourceManager sourceManager(diagnostics, *files);
+
+  auto fileEntry = files->getFile(absolutePath);
+  if (!fileEntry) {
+    reasonForFallback = "can't read the file";
+    return false;
+  }
+  auto fileID = sourceManager.createFileID(fileEntry, SourceLocation(), SrcMgr::C_User);
+
+  LangOptions langOptions;
+  langOptions.ObjC1 = 1;
+  langOptions.ObjC2 = 1;
+  langOptions.LineComment = 1;
+  if (llvm::StringRef(absolutePath).endswith(".mm")) {
+    langOptions.CPlusPlus = 1;
+    langOptions.CPlusPlus11 = 1;
+  }
+
+  Lexer lexer(fileID, sourceManager.getBuffer(fileID), sourceManager, langOptions);
+  TokenStream tokens(sourceManager, langOptions, absolutePath);
+
+  // collect the tokens, the preprocessor-directives are checked and left out
+  Token token;
+  lexer.LexFromRawLexer(token);
+  while (token.isNot(tok::eof)) {
+    if (token.is(tok::hash) && token.isAtStartOfLine()) {
+      lexer.LexFromRawLexer(token);
+      auto directive = token.is(tok::raw_identifier) ? Lexer::getSpelling(token, sourceManager, langOptions) : std::string();
+      if (directive != "import" && directive != "include" && directive != "pragma") {
+        // macros and conditional compilation can change everything the lexer sees
+        reasonForFallback = "contains #" + directive;
+        return false;
+      }
+      // the directive ends with the line
+      do {
+        lexer.LexFromRawLexer(token);
+      } while (token.isNot(tok::eof) && !token.isAtStartOfLine());
+      continue;
+    }
+    tokens.push_back(token);
+    lexer.LexFromRawLexer(token);
+  }
+
+  std::vector<ScannedMethod> scannedMethods;
+  Scanner scanner(tokens, scannedMethods, reasonForFallback);
+  if (!scanner.scan()) {
+    return false;
+  }
+
+  methods.insert(methods.end(), scannedMethods.begin(), scannedMethods.end());
+  return true;
+}
@@ -0,0 +1,50 @@
+//
+//  FastMethodScanner.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 24/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// finds the methods of all @implementation-blocks of a file by using the raw token-stream of the Lexer (as shown by -dump-tokens in 1_ClangPhasen),
+// without running the preprocessor, the parser or Sema
+// this only works as long as the file doesn't contain anything that changes the structure of the code behind the back of the lexer, like
+// macros or conditional compilation. In these cases scanFile gives up and the file has to be processed with the full AST
+
+#ifndef __XCodeBreakpointGenerator__FastMethodScanner__
+#define __XCodeBreakpointGenerator__FastMethodScanner__
+
+#include <string>
+#include <vector>
+
+#include "Breakpoint.h"
+
+struct ScannedReturn {
+  FullSourceRange sourceRange;
+  std::string returnValue; // the name of a parameter or self if the method returns one of them, empty otherwise
+};
+
+struct ScannedMethod {
+  std::string methodDeclaration;
+  std::string className;
+  std::string selector;
+  FullSourceRange bodyRange;
+  std::vector<std::string> parameterNames;
+  std::vector<std::string> parameterTypes; // the spelling of the type of each parameter, empty if it has none (and thus is id)
+  std::vector<ScannedReturn> returns;
+};
+
+class SharedFileSystem;
+
+class FastMethodScanner {
+  SharedFileSystem *sharedFileSystem;
+
+public:
+  // with a SharedFileSystem, the files are read through it, so they are not read again if they have to be parsed
+  FastMethodScanner(SharedFileSystem *sharedFileSystem = nullptr);
+
+  // returns false if the file can't be scanned with confidence, reasonForFallback tells why
+  bool scanFile(const std::string &filePath, std::vector<ScannedMethod> &methods, std::string &reasonForFallback);
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__FastMethodScanner__) */
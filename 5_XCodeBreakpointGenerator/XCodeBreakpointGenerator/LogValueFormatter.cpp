@@ -0,0 +1,149 @@
+//
+//  LogValueFormatter.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 27/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "LogValueFormatter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang;
+
+namespace {
+
+// longer expressions are not worth to be evaluated a second time, and they would blow up the log-message
+const size_t maximumReturnValueLength = 80;
+
+std::string printScalar(const std::string &expression) { return "@" + expression + "@"; }
+
+std::string printAddress(const std::string &expression) { return "@(void *)" + expression + "@"; }
+
+// the types of the SDK that start with a capital letter, but are not classes. Pointers to them are out-parameters like BOOL *stop
+const std::set<std::string> capitalisedScalarTypes = {"BOOL", "Boolean", "Class", "SEL", "NSInteger", "NSUInteger", "NSRange", "NSTimeInterval",
+                                                      "CGFloat", "CGPoint", "CGSize", "CGRect", "CGVector", "UIEdgeInsets", "UIOffset", "CGAffineTransform"};
+
+} // namespace
+
+LogValueFormatter::LogValueFormatter(const std::vector<std::string> &describedClasses)
+    : describedClasses(describedClasses.begin(), describedClasses.end()) {}
+
+std::string LogValueFormatter::formatObject(const std::string &expression) const {
+  return "@(const char *)object_getClassName(" + expression + ")@ " + printAddress(expression);
+}
+
+std::string LogValueFormatter::format(const std::string &expression, QualType type) const {
+  if (type.isNull()) {
+    return printScalar(expression);
+  }
+
+  if (auto objectPointerType = type->getAs<ObjCObjectPointerType>()) {
+    // a subclass of a described class can be described cheaply too, as long as it doesn't override -description
+    for (auto classInterface = objectPointerType->getInterfaceDecl(); classInterface; classInterface = classInterface->getSuperClass()) {
+      if (this->describedClasses.count(classInterface->getNameAsString())) {
+        return printScalar(expression);
+      }
+    }
+    return formatObject(expression);
+  }
+  if (type->isObjCSelType()) {
+    return "@(const char *)sel_getName(" + expression + ")@";
+  }
+  if (type->isBlockPointerType() || type->isFunctionPointerType() || type->isMemberPointerType()) {
+    return printAddress(expression);
+  }
+  if (type->isPointerType() && !type->getPointeeType()->isCharType()) {
+    return printAddress(expression);
+  }
+
+  // scalars, C-strings and structs like CGRect are printed by the debugger without running any code of the program
+  return printScalar(expression);
+}
+
+std::string LogValueFormatter::formatForTypeSpelling(const std::string &expression, const std::string &typeSpelling) const {
+  if (typeSpelling.find('^') != std::string::npos || typeSpelling.find("(*") != std::string::npos) {
+    return printAddress(expression);
+  }
+
+  // split the spelling into identifiers, qualifiers like const or __strong don't tell anything about the type
+  std::vector<std::string> identifiers;
+  std::string identifier;
+  for (auto c : typeSpelling + " ") {
+    if (std::isalnum(c) || c == '_') {
+      identifier += c;
+    } else if (!identifier.empty()) {
+      if (identifier != "const" && identifier != "volatile" && identifier.compare(0, 2, "__") != 0) {
+        identifiers.push_back(identifier);
+      }
+      identifier.clear();
+    }
+  }
+  if (identifiers.empty()) {
+    // methods without a type for a parameter or the return-value use id
+    return formatObject(expression);
+  }
+
+  auto &baseType = identifiers.front();
+  auto pointerDepth = std::count(typeSpelling.begin(), typeSpelling.end(), '*');
+
+  if ((baseType == "id" || baseType == "instancetype" || baseType == "Class") && pointerDepth == 0) {
+    return formatObject(expression);
+  }
+  if (baseType == "SEL" && pointerDepth == 0) {
+    return "@(const char *)sel_getName(" + expression + ")@";
+  }
+  if (pointerDepth == 1 && baseType == "char") {
+    return printScalar(expression);
+  }
+  // without Sema, a pointer to a type starting with a capital letter is assumed to be an object
+  // its superclasses are unknown, so it is only described if its own class is one of the described classes
+  // out-parameters like NSError ** point to an object-pointer, the debugger must not treat them as objects
+  if (pointerDepth == 1 && std::isupper(baseType[0]) && !capitalisedScalarTypes.count(baseType)) {
+    return this->describedClasses.count(baseType) ? printScalar(expression) : formatObject(expression);
+  }
+  if (pointerDepth > 0) {
+    return printAddress(expression);
+  }
+
+  return printScalar(expression);
+}
+
+std::string LogValueFormatter::formatReturnValue(const Expr *returnValue, ASTContext &context) const {
+  if (!returnValue) {
+    return std::string();
+  }
+  auto value = returnValue->IgnoreParenImpCasts();
+
+  if (auto declRef = dyn_cast<DeclRefExpr>(value)) {
+    return format(declRef->getDecl()->getNameAsString(), declRef->getType());
+  }
+
+  // the breakpoint is hit before the statement is executed, so the debugger has to evaluate the expression on its own.
+  // This is only done if it doesn't change anything, which excludes message-sends, calls and property-accesses as well
+  if (value->HasSideEffects(context)) {
+    return std::string();
+  }
+
+  auto &sourceManager = context.getSourceManager();
+  auto range = value->getSourceRange();
+  if (range.getBegin().isMacroID() || range.getEnd().isMacroID()) {
+    return std::string();
+  }
+  auto source = Lexer::getSourceText(CharSourceRange::getTokenRange(range), sourceManager, context.getLangOpts()).str();
+
+  // @ and " would end the expression within the log-message, the others would have to be escaped within the XML
+  if (source.empty() || source.size() > maximumReturnValueLength || source.find_first_of("@\"<>&\n\\") != std::string::npos) {
+    return std::string();
+  }
+
+  return format("(" + source + ")", value->getType());
+}
@@ -0,0 +1,43 @@
+//
+//  LogValueFormatter.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 27/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// decides how the value of a parameter or a return-statement is printed by the log-action of a breakpoint
+// the debugger prints an object within @...@ by sending it -description on every hit, which is slow and allocates a lot for collections.
+// Thus objects are printed as class-name and address, only the classes within the allow-list are described. Scalars are printed directly
+
+#ifndef __XCodeBreakpointGenerator__LogValueFormatter__
+#define __XCodeBreakpointGenerator__LogValueFormatter__
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Expr.h"
+
+class LogValueFormatter {
+  std::set<std::string> describedClasses;
+
+  std::string formatObject(const std::string &expression) const;
+
+public:
+  LogValueFormatter(const std::vector<std::string> &describedClasses);
+
+  // returns the part of the log-message that prints the value of expression
+  std::string format(const std::string &expression, clang::QualType type) const;
+
+  // the same for the --fast mode, where only the spelling of the type is known, like "NSArray *" or "NSInteger"
+  // the superclasses are unknown without Sema, so only the described classes themselves are described, not their subclasses
+  std::string formatForTypeSpelling(const std::string &expression, const std::string &typeSpelling) const;
+
+  // returns the part of the log-message that prints the value of a return-statement
+  // the debugger evaluates the expression a second time, so this only works for expressions without side-effects. It returns an empty string otherwise
+  std::string formatReturnValue(const clang::Expr *returnValue, clang::ASTContext &context) const;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__LogValueFormatter__) */
@@ -0,0 +1,151 @@
+//
+//  ParallelTool.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 22/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "ParallelTool.h"
+#include "SharedFileSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "clang/Basic/FileManager.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+
+using namespace clang;
+using namespace tooling;
+
+namespace {
+
+uint64_t currentResidentMemory() {
+#ifdef __APPLE__
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+    return info.resident_size;
+  }
+#else
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0, resident = 0;
+  if (statm >> size >> resident) {
+    return resident * sysconf(_SC_PAGESIZE);
+  }
+#endif
+  return 0;
+}
+
+// the memory of the AST is freed after every file, but malloc keeps it for later use by default
+void releaseFreedMemory() {
+#ifdef __APPLE__
+  malloc_zone_pressure_relief(nullptr, 0);
+#endif
+}
+
+} // namespace
+
+ParallelTool::ParallelTool(const CompilationDatabase &compilations, const std::vector<std::string> &sourcePaths, unsigned jobs)
+    : compilations(compilations), sourcePaths(sourcePaths), jobs(jobs), maxResidentMemory(0), sharedFileSystem(nullptr) {
+  if (this->jobs == 0) {
+    this->jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+void ParallelTool::setMaxResidentMemory(uint64_t maxResidentMemory) { this->maxResidentMemory = maxResidentMemory; }
+
+void ParallelTool::setSharedFileSystem(SharedFileSystem *sharedFileSystem) { this->sharedFileSystem = sharedFileSystem; }
+
+int ParallelTool::run(const std::function<int(const std::string &filePath)> &work) {
+  std::atomic<size_t> nextFile(0);
+  std::atomic<unsigned> activeWorkers(0);
+  std::atomic<int> result(0);
+  std::mutex admissionMutex;
+
+  auto worker = [this, &work, &nextFile, &activeWorkers, &result, &admissionMutex]() {
+    while (true) {
+      {
+        // only one worker at a time waits for the memory to drop, so they don't start all at once when it does
+        // a worker is never held back if no other file is processed, else nobody would ever free anything
+        std::lock_guard<std::mutex> lock(admissionMutex);
+        while (this->maxResidentMemory && activeWorkers > 0 && nextFile < this->sourcePaths.size() &&
+               currentResidentMemory() > this->maxResidentMemory) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        ++activeWorkers;
+      }
+
+      size_t index = nextFile++;
+      if (index >= this->sourcePaths.size()) {
+        --activeWorkers;
+        return;
+      }
+      if (work(this->sourcePaths[index]) != 0) {
+        result = 1;
+      }
+      releaseFreedMemory();
+      --activeWorkers;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  auto threadCount = std::min<size_t>(this->jobs, this->sourcePaths.size());
+  for (size_t i = 1; i < threadCount; ++i) {
+    threads.push_back(std::thread(worker));
+  }
+  // the calling thread does its share of the work, so -j 1 doesn't spawn any thread at all
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  return result;
+}
+
+int ParallelTool::runOnFile(const std::string &filePath, FrontendActionFactory *factory) {
+  auto absolutePath = getAbsolutePath(filePath);
+  auto compileCommands = this->compilations.getCompileCommands(absolutePath);
+  if (compileCommands.empty()) {
+    std::cerr << "skipping " << filePath << ": no compile-command found in the compilation-database" << std::endl;
+    return 1;
+  }
+
+  int result = 0;
+  for (auto &compileCommand : compileCommands) {
+    auto commandLine = ClangSyntaxOnlyAdjuster().Adjust(compileCommand.CommandLine);
+    if (commandLine.empty()) {
+      continue;
+    }
+    commandLine.insert(commandLine.begin() + 1, "-working-directory=" + compileCommand.Directory);
+
+    // FileManagers are not thread-safe, so without a SharedFileSystem every invocation gets its own
+    IntrusiveRefCntPtr<FileManager> files;
+    if (this->sharedFileSystem) {
+      files = this->sharedFileSystem->getFileManager(compileCommand.Directory);
+    } else {
+      FileSystemOptions options;
+      options.WorkingDir = compileCommand.Directory;
+      files = new FileManager(options);
+    }
+    ToolInvocation invocation(std::move(commandLine), factory, files.get());
+    if (!invocation.run()) {
+      std::cerr << "error while processing " << filePath << std::endl;
+      result = 1;
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,54 @@
+//
+//  ParallelTool.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 22/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// a replacement for ClangTool that processes multiple files at once
+// ClangTool changes the working-directory of the whole process for every compile-command, so it can't be used from multiple threads.
+// ParallelTool passes the directory of the compile-command as -working-directory to the frontend instead
+
+#ifndef __XCodeBreakpointGenerator__ParallelTool__
+#define __XCodeBreakpointGenerator__ParallelTool__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+
+class SharedFileSystem;
+
+class ParallelTool {
+  const clang::tooling::CompilationDatabase &compilations;
+  std::vector<std::string> sourcePaths;
+  unsigned jobs;
+  uint64_t maxResidentMemory;
+  SharedFileSystem *sharedFileSystem;
+
+public:
+  // jobs == 0 uses one thread per core
+  ParallelTool(const clang::tooling::CompilationDatabase &compilations, const std::vector<std::string> &sourcePaths, unsigned jobs);
+
+  // no new file is started while the resident memory of the process is above maxResidentMemory (in bytes) and another file is still processed
+  // 0 means there is no limit
+  void setMaxResidentMemory(uint64_t maxResidentMemory);
+
+  // reads all files through the given SharedFileSystem instead of reading them again for every compile-command
+  // nullptr (the default) gives every compile-command its own FileManager, which doesn't keep anything after the file was processed
+  void setSharedFileSystem(SharedFileSystem *sharedFileSystem);
+
+  // calls work once for every source-file, from multiple threads at once
+  // returns 0 if every call to work returned 0, 1 otherwise
+  int run(const std::function<int(const std::string &filePath)> &work);
+
+  // runs the action on every compile-command of the file with -fsyntax-only, can be called from multiple threads at once
+  // the AST and everything else that belongs to the file is freed before runOnFile returns
+  int runOnFile(const std::string &filePath, clang::tooling::FrontendActionFactory *factory);
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__ParallelTool__) */
@@ -0,0 +1,91 @@
+//
+//  PassManager.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "PassManager.h"
+
+#include <iostream>
+#include <memory>
+#include <set>
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Tooling/Tooling.h"
+
+#include "ParallelTool.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace ast_matchers;
+
+void PassManager::addPass(Pass *pass) { this->passes.push_back(pass); }
+
+void PassManager::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath, bool isRequested) {
+  for (auto pass : this->passes) {
+    if (isRequested || pass->needsUnrequestedFile(sourceFilePath)) {
+      pass->registerMatchers(finder, sourceFilePath);
+    }
+  }
+}
+
+std::vector<std::string> PassManager::collectFiles(const std::vector<std::string> &requestedFiles, const std::vector<std::string> &allFiles) const {
+  std::vector<std::string> files = requestedFiles;
+  std::set<std::string> absoluteRequestedFiles;
+  for (auto &filePath : requestedFiles) {
+    absoluteRequestedFiles.insert(getAbsolutePath(filePath));
+  }
+
+  for (auto &filePath : allFiles) {
+    if (absoluteRequestedFiles.count(getAbsolutePath(filePath))) {
+      continue;
+    }
+    for (auto pass : this->passes) {
+      if (pass->needsUnrequestedFile(filePath)) {
+        files.push_back(filePath);
+        break;
+      }
+    }
+  }
+  return files;
+}
+
+int PassManager::run(ParallelTool &tool, const std::vector<std::string> &requestedFiles) {
+  std::set<std::string> requested(requestedFiles.begin(), requestedFiles.end());
+  return tool.run([this, &tool, &requested](const std::string &filePath) {
+    // every thread needs its own MatchFinder, the passes register their matchers again for every file
+    MatchFinder finder;
+    registerMatchers(finder, filePath, requested.count(filePath) > 0);
+    return tool.runOnFile(filePath, newFrontendActionFactory(&finder).get());
+  });
+}
+
+int PassManager::runOnASTs(ParallelTool &tool) {
+  return tool.run([this](const std::string &astFilePath) {
+    IntrusiveRefCntPtr<DiagnosticsEngine> diagnostics(CompilerInstance::createDiagnostics(new DiagnosticOptions()));
+    std::unique_ptr<ASTUnit> astUnit(ASTUnit::LoadFromASTFile(astFilePath, diagnostics, FileSystemOptions()));
+    if (!astUnit) {
+      std::cerr << "could not load the AST " << astFilePath << std::endl;
+      return 1;
+    }
+
+    MatchFinder finder;
+    registerMatchers(finder, astUnit->getOriginalSourceFileName().str(), true);
+    finder.matchAST(astUnit->getASTContext());
+    return 0;
+  });
+}
+
+int PassManager::finish(std::ostream &report) {
+  int result = 0;
+  for (auto pass : this->passes) {
+    if (pass->finish(report) != 0) {
+      result = 1;
+    }
+  }
+  return result;
+}
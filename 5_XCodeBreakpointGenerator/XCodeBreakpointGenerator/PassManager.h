@@ -0,0 +1,64 @@
+//
+//  PassManager.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// every kind of output of the tool (the breakpoints at the entry of a method, at its return-statements, the call-graph, the checks, ...)
+// is a pass that registers its matchers on the MatchFinder of a translation-unit. The PassManager parses every file once and runs all
+// enabled passes within that single run, so adding a pass doesn't cost another parse of the whole project
+
+#ifndef __XCodeBreakpointGenerator__PassManager__
+#define __XCodeBreakpointGenerator__PassManager__
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+class ParallelTool;
+
+class Pass {
+public:
+  virtual ~Pass() {}
+
+  // the name of the pass for --passes
+  virtual const char *getName() const = 0;
+
+  // whether the pass needs a file of the compilation-database that is not among the given files, like the main-file
+  virtual bool needsUnrequestedFile(const std::string &sourceFilePath) const { return false; }
+
+  // called with a new MatchFinder for every translation-unit, sourceFilePath is the file it was created from
+  // the callbacks are called from multiple threads at once
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) = 0;
+
+  // called once after all files were processed, reports of the pass are written to report
+  // returns 0 if the pass succeeded
+  virtual int finish(std::ostream &report) { return 0; }
+};
+
+class PassManager {
+  std::vector<Pass *> passes;
+
+  void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath, bool isRequested);
+
+public:
+  void addPass(Pass *pass);
+
+  // returns the requested files, followed by the files of the compilation-database that are needed by one of the passes
+  std::vector<std::string> collectFiles(const std::vector<std::string> &requestedFiles, const std::vector<std::string> &allFiles) const;
+
+  // parses every file of the tool once and runs all passes on it, the files that were not requested are only given to the passes that need them
+  int run(ParallelTool &tool, const std::vector<std::string> &requestedFiles);
+
+  // runs all passes on the ASTs that were serialized by the build (clang -emit-ast)
+  int runOnASTs(ParallelTool &tool);
+
+  // returns 0 if every pass succeeded
+  int finish(std::ostream &report);
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__PassManager__) */
@@ -0,0 +1,138 @@
+//
+//  PerformanceChecker.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 23/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "PerformanceChecker.h"
+
+#include <tuple>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/StmtObjC.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/ASTMatchers/ASTMatchersInternal.h"
+#include "clang/Basic/SourceManager.h"
+
+using namespace clang;
+using namespace ast_matchers;
+
+// the macros for custom matchers refer to internal:: without qualification, so they have to be used within ast_matchers
+namespace clang {
+namespace ast_matchers {
+
+// node-matchers for the Objective-C-statements that are not part of the ASTMatchers (yet)
+const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCForCollectionStmt> objcForCollectionStmt;
+const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCBoxedExpr> objcBoxedExpr;
+const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCArrayLiteral> objcArrayLiteral;
+const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCDictionaryLiteral> objcDictionaryLiteral;
+const internal::VariadicDynCastAllOfMatcher<Stmt, ObjCPropertyRefExpr> objcPropertyRefExpr;
+
+// matches property-accesses whose receiver is a property-access itself, like self.view.bounds
+AST_MATCHER(ObjCPropertyRefExpr, isPropertyChain) {
+  if (!Node.isObjectReceiver()) {
+    return false;
+  }
+  auto base = Node.getBase()->IgnoreParenImpCasts();
+  // the inner access is wrapped into a PseudoObjectExpr once it is used as rvalue
+  if (auto pseudoObject = dyn_cast<PseudoObjectExpr>(base)) {
+    base = pseudoObject->getSyntacticForm()->IgnoreParenImpCasts();
+  }
+  return isa<ObjCPropertyRefExpr>(base);
+}
+
+// hasBody() of the ASTMatchers doesn't support the for-in-loop
+AST_MATCHER_P(ObjCForCollectionStmt, hasCollectionBody, internal::Matcher<Stmt>, InnerMatcher) {
+  const Stmt *body = Node.getBody();
+  return body && InnerMatcher.matches(*body, Finder, Builder);
+}
+
+} // namespace ast_matchers
+} // namespace clang
+
+namespace {
+
+struct Check {
+  const char *name;
+  const char *message;
+};
+
+const Check loggingCheck = {"performance-logging-in-loop", "logging within a loop"};
+const Check boxingCheck = {"performance-boxing-in-loop", "boxing a value within a loop allocates an object on every iteration"};
+const Check autoreleaseCheck = {"performance-autorelease-in-loop",
+                                "autoreleased object created within a loop, it lives until the surrounding autoreleasepool is drained"};
+const Check formatCheck = {"performance-format-in-loop", "formatting a string within a loop"};
+const Check propertyChainCheck = {"performance-property-chain-in-loop",
+                                  "chained property-access within a loop sends a message for every step, cache the value in a local variable"};
+
+// matches the loops that contain a node matched by inner within their bodies
+// the header of a loop, like the initialisation of a for-loop or the collection of a for-in-loop, is the place to cache a value, so it is not checked
+StatementMatcher loopWithinBody(const StatementMatcher &inner) {
+  StatementMatcher withinBody = eachOf(inner, forEachDescendant(inner));
+  return stmt(anyOf(forStmt(hasBody(withinBody)), whileStmt(hasBody(withinBody)), doStmt(hasBody(withinBody)),
+                    objcForCollectionStmt(hasCollectionBody(withinBody))));
+}
+
+} // namespace
+
+bool PerformanceChecker::Finding::operator<(const Finding &finding) const {
+  return std::tie(this->filePath, this->line, this->column, this->check) < std::tie(finding.filePath, finding.line, finding.column, finding.check);
+}
+
+void PerformanceChecker::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath) {
+  // the matches of nested loops are reported once, as the findings are a set
+  finder.addMatcher(loopWithinBody(callExpr(callee(functionDecl(anyOf(hasName("NSLog"), hasName("NSLogv"), hasName("printf"), hasName("fprintf")))))
+                                       .bind(loggingCheck.name)),
+                    this);
+  finder.addMatcher(loopWithinBody(stmt(anyOf(objcBoxedExpr(), objcArrayLiteral(), objcDictionaryLiteral(), objcMessageExpr(matchesSelector("^numberWith"))))
+                                       .bind(boxingCheck.name)),
+                    this);
+  finder.addMatcher(loopWithinBody(objcMessageExpr(matchesSelector("^(array|dictionary|set|orderedSet|data|string)With"),
+                                                   unless(anyOf(hasSelector("stringWithFormat:"), hasSelector("stringWithFormat:arguments:"))))
+                                       .bind(autoreleaseCheck.name)),
+                    this);
+  finder.addMatcher(loopWithinBody(objcMessageExpr(anyOf(hasSelector("stringWithFormat:"), hasSelector("stringWithFormat:arguments:"),
+                                                         hasSelector("initWithFormat:"), hasSelector("appendFormat:"))).bind(formatCheck.name)),
+                    this);
+  finder.addMatcher(loopWithinBody(objcPropertyRefExpr(isPropertyChain()).bind(propertyChainCheck.name)), this);
+}
+
+void PerformanceChecker::run(const MatchFinder::MatchResult &Result) {
+  auto &sourceManager = Result.Context->getSourceManager();
+
+  for (auto check : {loggingCheck, boxingCheck, autoreleaseCheck, formatCheck, propertyChainCheck}) {
+    auto stmt = Result.Nodes.getStmtAs<Stmt>(check.name);
+    if (!stmt) {
+      continue;
+    }
+
+    auto location = sourceManager.getExpansionLoc(stmt->getLocStart());
+    if (!sourceManager.isInMainFile(location)) {
+      return;
+    }
+
+    Finding finding;
+    finding.filePath = sourceManager.getFilename(location);
+    finding.line = sourceManager.getExpansionLineNumber(location);
+    finding.column = sourceManager.getExpansionColumnNumber(location);
+    finding.check = check.name;
+    finding.message = check.message;
+
+    std::lock_guard<std::mutex> lock(this->findingsMutex);
+    this->findings.insert(finding);
+    return;
+  }
+}
+
+int PerformanceChecker::finish(std::ostream &report) { return printFindings(report) > 0 ? 1 : 0; }
+
+unsigned long PerformanceChecker::printFindings(std::ostream &output) const {
+  for (auto &finding : this->findings) {
+    output << finding.filePath << ":" << finding.line << ":" << finding.column << ": warning: " << finding.message << " [" << finding.check << "]"
+           << std::endl;
+  }
+  return this->findings.size();
+}
@@ -0,0 +1,52 @@
+//
+//  PerformanceChecker.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 23/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// looks for code within loop-bodies that is known to be expensive in methods that run on every frame:
+// logging, boxing, autoreleased allocations, stringWithFormat: and chains of property-accesses like self.view.bounds
+// the findings are printed like compiler-warnings (file:line:column: warning: message [check]), so they can be processed by CI-tools
+
+#ifndef __XCodeBreakpointGenerator__PerformanceChecker__
+#define __XCodeBreakpointGenerator__PerformanceChecker__
+
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+#include "PassManager.h"
+
+class PerformanceChecker : public Pass, public clang::ast_matchers::MatchFinder::MatchCallback {
+  struct Finding {
+    std::string filePath;
+    unsigned line;
+    unsigned column;
+    std::string check;
+    std::string message;
+
+    bool operator<(const Finding &finding) const;
+  };
+
+  // only findings within the main-files are reported, the set keeps them sorted and drops duplicates
+  std::set<Finding> findings;
+  std::mutex findingsMutex;
+
+public:
+  virtual const char *getName() const override { return "performance"; }
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) override;
+  virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
+
+  // prints the findings and fails if there are any
+  virtual int finish(std::ostream &report) override;
+
+  // returns the number of findings
+  unsigned long printFindings(std::ostream &output) const;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__PerformanceChecker__) */
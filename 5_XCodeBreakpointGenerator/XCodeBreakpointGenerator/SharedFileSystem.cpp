@@ -0,0 +1,197 @@
+//
+//  SharedFileSystem.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 28/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "SharedFileSystem.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "clang/Tooling/Tooling.h"
+
+using namespace clang;
+
+namespace {
+
+// refers to the contents of the cache without copying them and keeps them alive, even if the cache drops them in the meantime
+class SharedMemoryBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> contents;
+  std::string name;
+
+public:
+  SharedMemoryBuffer(const std::shared_ptr<llvm::MemoryBuffer> &contents, const std::string &name) : contents(contents), name(name) {
+    // the cached buffers are always null-terminated, so they satisfy every request
+    init(contents->getBufferStart(), contents->getBufferEnd(), true);
+  }
+
+  virtual const char *getBufferIdentifier() const override { return this->name.c_str(); }
+
+  virtual BufferKind getBufferKind() const override { return this->contents->getBufferKind(); }
+};
+
+// a file whose contents belong to the cache, every translation-unit gets a MemoryBuffer that shares them
+class CachedFile : public vfs::File {
+  vfs::Status fileStatus;
+  std::shared_ptr<llvm::MemoryBuffer> contents;
+
+public:
+  CachedFile(const vfs::Status &fileStatus, const std::shared_ptr<llvm::MemoryBuffer> &contents) : fileStatus(fileStatus), contents(contents) {}
+
+  virtual llvm::ErrorOr<vfs::Status> status() override { return this->fileStatus; }
+
+  virtual std::error_code getBuffer(const llvm::Twine &name, std::unique_ptr<llvm::MemoryBuffer> &result, int64_t fileSize, bool requiresNullTerminator,
+                                    bool isVolatile) override {
+    result.reset(new SharedMemoryBuffer(this->contents, name.str()));
+    return std::error_code();
+  }
+
+  virtual std::error_code close() override { return std::error_code(); }
+
+  virtual void setName(StringRef name) override { this->fileStatus.setName(name); }
+};
+
+} // namespace
+
+CachingFileSystem::CachingFileSystem(llvm::IntrusiveRefCntPtr<vfs::FileSystem> underlyingFileSystem)
+    : underlyingFileSystem(underlyingFileSystem), cachedBytes(0), maxCachedBytes(0), useCounter(0) {}
+
+void CachingFileSystem::addOverlay(const std::string &filePath, std::unique_ptr<llvm::MemoryBuffer> contents) {
+  std::lock_guard<std::mutex> lock(this->cacheMutex);
+  this->cachedBytes += contents->getBufferSize();
+  this->overlay[filePath] = std::shared_ptr<llvm::MemoryBuffer>(contents.release());
+}
+
+void CachingFileSystem::setMaxCachedBytes(uint64_t maxCachedBytes) {
+  std::lock_guard<std::mutex> lock(this->cacheMutex);
+  this->maxCachedBytes = maxCachedBytes;
+  evictUnusedContents();
+}
+
+void CachingFileSystem::evictUnusedContents() {
+  if (!this->maxCachedBytes || this->cachedBytes <= this->maxCachedBytes) {
+    return;
+  }
+
+  // the cache itself holds the only reference to the contents no translation-unit uses at the moment
+  std::vector<std::map<std::string, CachedContents>::iterator> unusedContents;
+  for (auto cached = this->contentCache.begin(); cached != this->contentCache.end(); ++cached) {
+    if (cached->second.contents.use_count() == 1) {
+      unusedContents.push_back(cached);
+    }
+  }
+  std::sort(unusedContents.begin(), unusedContents.end(), [](const std::map<std::string, CachedContents>::iterator &first,
+                                                              const std::map<std::string, CachedContents>::iterator &second) {
+    return first->second.lastUse < second->second.lastUse;
+  });
+
+  for (auto &cached : unusedContents) {
+    if (this->cachedBytes <= this->maxCachedBytes) {
+      break;
+    }
+    this->cachedBytes -= cached->second.contents->getBufferSize();
+    this->contentCache.erase(cached);
+  }
+}
+
+llvm::ErrorOr<vfs::Status> CachingFileSystem::status(const llvm::Twine &path) {
+  auto filePath = path.str();
+  {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    auto cached = this->statusCache.find(filePath);
+    if (cached != this->statusCache.end()) {
+      return cached->second;
+    }
+  }
+
+  auto fileStatus = this->underlyingFileSystem->status(filePath);
+  std::lock_guard<std::mutex> lock(this->cacheMutex);
+  auto overlaid = this->overlay.find(filePath);
+  if (fileStatus && overlaid != this->overlay.end()) {
+    // the FileManager reads as many bytes as the status tells
+    fileStatus = vfs::Status(fileStatus->getName(), fileStatus->getName(), fileStatus->getUniqueID(), fileStatus->getLastModificationTime(),
+                             fileStatus->getUser(), fileStatus->getGroup(), overlaid->second->getBufferSize(), fileStatus->getType(),
+                             fileStatus->getPermissions());
+  }
+  return this->statusCache.insert(std::make_pair(filePath, fileStatus)).first->second;
+}
+
+std::error_code CachingFileSystem::openFileForRead(const llvm::Twine &path, std::unique_ptr<vfs::File> &result) {
+  auto filePath = path.str();
+  auto fileStatus = status(filePath);
+  if (!fileStatus) {
+    return fileStatus.getError();
+  }
+
+  std::shared_ptr<llvm::MemoryBuffer> contents;
+  {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    auto overlaid = this->overlay.find(filePath);
+    if (overlaid != this->overlay.end()) {
+      contents = overlaid->second;
+    } else {
+      auto cached = this->contentCache.find(filePath);
+      if (cached != this->contentCache.end()) {
+        cached->second.lastUse = ++this->useCounter;
+        contents = cached->second.contents;
+      }
+    }
+  }
+
+  if (!contents) {
+    // read outside of the lock, two threads that need the same header at once may both read it, but only the first one is kept
+    // big files are mapped into memory instead of being copied, they are never written while the tool is running
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    if (auto errorCode = this->underlyingFileSystem->getBufferForFile(filePath, buffer, fileStatus->getSize(), true, false)) {
+      return errorCode;
+    }
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    CachedContents cachedContents = {std::shared_ptr<llvm::MemoryBuffer>(buffer.release()), 0};
+    auto inserted = this->contentCache.insert(std::make_pair(filePath, cachedContents));
+    if (inserted.second) {
+      this->cachedBytes += inserted.first->second.contents->getBufferSize();
+    }
+    inserted.first->second.lastUse = ++this->useCounter;
+    contents = inserted.first->second.contents;
+    // the new contents are referred to by contents, so they are never dropped right away
+    evictUnusedContents();
+  }
+
+  result.reset(new CachedFile(*fileStatus, contents));
+  return std::error_code();
+}
+
+vfs::directory_iterator CachingFileSystem::dir_begin(const llvm::Twine &directory, std::error_code &errorCode) {
+  // only used for framework- and module-lookups, not worth caching
+  return this->underlyingFileSystem->dir_begin(directory, errorCode);
+}
+
+SharedFileSystem::SharedFileSystem() : fileSystem(new CachingFileSystem(vfs::getRealFileSystem())) {}
+
+bool SharedFileSystem::addUnsavedFile(const std::string &filePath, const std::string &contentsPath) {
+  std::unique_ptr<llvm::MemoryBuffer> contents;
+  if (auto errorCode = vfs::getRealFileSystem()->getBufferForFile(contentsPath, contents)) {
+    std::cerr << "can't read the unsaved contents of " << filePath << " from " << contentsPath << ": " << errorCode.message() << std::endl;
+    return false;
+  }
+  // copied, so the editor may remove the file as soon as the tool has started
+  std::unique_ptr<llvm::MemoryBuffer> copy(llvm::MemoryBuffer::getMemBufferCopy(contents->getBuffer(), filePath));
+  this->fileSystem->addOverlay(tooling::getAbsolutePath(filePath), std::move(copy));
+  return true;
+}
+
+FileManager *SharedFileSystem::getFileManager(const std::string &workingDirectory) {
+  std::lock_guard<std::mutex> lock(this->fileManagersMutex);
+  auto &fileManager = this->fileManagers[std::make_pair(std::this_thread::get_id(), workingDirectory)];
+  if (!fileManager) {
+    // relative paths of the compile-command are resolved by the FileManager, not by the process
+    FileSystemOptions options;
+    options.WorkingDir = workingDirectory;
+    fileManager = new FileManager(options, this->fileSystem);
+  }
+  return fileManager.get();
+}
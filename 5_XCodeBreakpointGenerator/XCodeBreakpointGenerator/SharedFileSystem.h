@@ -0,0 +1,87 @@
+//
+//  SharedFileSystem.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 28/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// shares the files between all translation-units, so a header that is included by hundreds of files is looked up and read only once
+// the contents are kept as (memory-mapped) MemoryBuffers by a virtual file-system that every FileManager reads through. The file-system can overlay
+// files with unsaved buffers of an editor, the tool sees their contents instead of the ones on disk
+// the cached contents can be limited in size, the least recently used files that no translation-unit refers to anymore are dropped first
+// a FileManager is not thread-safe, so every thread gets its own for every working-directory, which is reused for all files it processes
+
+#ifndef __XCodeBreakpointGenerator__SharedFileSystem__
+#define __XCodeBreakpointGenerator__SharedFileSystem__
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+// a file-system that caches the status and the contents of every file it was asked for
+// missing files are cached as well, most lookups are made for headers within the wrong search-path
+class CachingFileSystem : public clang::vfs::FileSystem {
+  llvm::IntrusiveRefCntPtr<clang::vfs::FileSystem> underlyingFileSystem;
+
+  struct CachedContents {
+    std::shared_ptr<llvm::MemoryBuffer> contents;
+    uint64_t lastUse;
+  };
+
+  std::mutex cacheMutex;
+  std::map<std::string, llvm::ErrorOr<clang::vfs::Status>> statusCache;
+  std::map<std::string, CachedContents> contentCache;
+  std::map<std::string, std::shared_ptr<llvm::MemoryBuffer>> overlay;
+  uint64_t cachedBytes;
+  uint64_t maxCachedBytes;
+  uint64_t useCounter;
+
+  // drops the least recently used contents until the cache fits into maxCachedBytes again, has to be called with the cacheMutex locked
+  // contents that are still referred to by a buffer of a translation-unit are kept, dropping them wouldn't free anything
+  void evictUnusedContents();
+
+public:
+  CachingFileSystem(llvm::IntrusiveRefCntPtr<clang::vfs::FileSystem> underlyingFileSystem);
+
+  // the contents replace the ones of the existing file at filePath, which has to be absolute
+  // has to be called before the first file is read, the overlaid files are never dropped
+  void addOverlay(const std::string &filePath, std::unique_ptr<llvm::MemoryBuffer> contents);
+
+  // the cached contents of files on disk are dropped once all cached contents exceed maxCachedBytes (in bytes), 0 means there is no limit
+  void setMaxCachedBytes(uint64_t maxCachedBytes);
+
+  virtual llvm::ErrorOr<clang::vfs::Status> status(const llvm::Twine &path) override;
+  virtual std::error_code openFileForRead(const llvm::Twine &path, std::unique_ptr<clang::vfs::File> &result) override;
+  virtual clang::vfs::directory_iterator dir_begin(const llvm::Twine &directory, std::error_code &errorCode) override;
+};
+
+class SharedFileSystem {
+  llvm::IntrusiveRefCntPtr<CachingFileSystem> fileSystem;
+
+  std::mutex fileManagersMutex;
+  std::map<std::pair<std::thread::id, std::string>, llvm::IntrusiveRefCntPtr<clang::FileManager>> fileManagers;
+
+public:
+  SharedFileSystem();
+
+  // reads the file at contentsPath and lets the tool see its contents instead of the ones of filePath
+  // returns false if contentsPath can't be read
+  bool addUnsavedFile(const std::string &filePath, const std::string &contentsPath);
+
+  // returns the FileManager of the calling thread for the given working-directory of a compile-command
+  clang::FileManager *getFileManager(const std::string &workingDirectory);
+
+  // see CachingFileSystem::setMaxCachedBytes
+  void setMaxCachedBytes(uint64_t maxCachedBytes) { this->fileSystem->setMaxCachedBytes(maxCachedBytes); }
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__SharedFileSystem__) */
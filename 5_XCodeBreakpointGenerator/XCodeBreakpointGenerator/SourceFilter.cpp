@@ -0,0 +1,95 @@
+//
+//  SourceFilter.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 29/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "SourceFilter.h"
+
+#include <algorithm>
+
+#include "clang/Tooling/Tooling.h"
+
+namespace {
+
+// * matches any number of characters (including /), ? a single one, everything else only itself
+std::string regexForGlob(const std::string &glob) {
+  std::string regex;
+  for (auto c : glob) {
+    if (c == '*') {
+      regex += ".*";
+    } else if (c == '?') {
+      regex += ".";
+    } else if (std::string("\\^$.|+()[]{}").find(c) != std::string::npos) {
+      regex += std::string("\\") + c;
+    } else {
+      regex += c;
+    }
+  }
+  return regex;
+}
+
+bool startsWith(const std::string &string, const std::string &prefix) { return string.compare(0, prefix.size(), prefix) == 0; }
+
+} // namespace
+
+void NameFilter::addPattern(const std::regex &pattern, bool include) { (include ? this->includes : this->excludes).push_back(pattern); }
+
+bool NameFilter::accepts(const std::string &name) const {
+  auto matches = [&name](const std::regex &pattern) { return std::regex_match(name, pattern); };
+  if (!this->includes.empty() && std::none_of(this->includes.begin(), this->includes.end(), matches)) {
+    return false;
+  }
+  return std::none_of(this->excludes.begin(), this->excludes.end(), matches);
+}
+
+bool SourceFilter::addPattern(const std::string &pattern, bool include, std::string &errorMessage) {
+  auto separator = pattern.find(':');
+  if (separator == std::string::npos) {
+    errorMessage = "expected file:, class: or selector: in front of the pattern " + pattern;
+    return false;
+  }
+
+  auto kind = pattern.substr(0, separator);
+  NameFilter *filter = nullptr;
+  if (kind == "file") {
+    filter = &this->fileFilter;
+  } else if (kind == "class") {
+    filter = &this->classFilter;
+  } else if (kind == "selector") {
+    filter = &this->selectorFilter;
+  } else {
+    errorMessage = "unknown kind of pattern " + kind + ", expected file, class or selector";
+    return false;
+  }
+
+  auto expression = pattern.substr(separator + 1);
+  if (startsWith(expression, "regex:")) {
+    expression = expression.substr(6);
+  } else {
+    expression = regexForGlob(expression);
+  }
+
+  try {
+    filter->addPattern(std::regex(expression, std::regex::optimize), include);
+  } catch (const std::regex_error &error) {
+    errorMessage = "invalid pattern " + pattern + ": " + error.what();
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> SourceFilter::filterFiles(const std::vector<std::string> &filePaths) const {
+  if (this->fileFilter.isEmpty()) {
+    return filePaths;
+  }
+  std::vector<std::string> acceptedFilePaths;
+  for (auto &filePath : filePaths) {
+    if (this->fileFilter.accepts(clang::tooling::getAbsolutePath(filePath))) {
+      acceptedFilePaths.push_back(filePath);
+    }
+  }
+  return acceptedFilePaths;
+}
@@ -0,0 +1,50 @@
+//
+//  SourceFilter.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 29/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// the --include- and --exclude-patterns for file-paths, class-names and selectors
+// every pattern is compiled into a std::regex once when the options are parsed, globs are translated into a regex first
+
+#ifndef __XCodeBreakpointGenerator__SourceFilter__
+#define __XCodeBreakpointGenerator__SourceFilter__
+
+#include <regex>
+#include <string>
+#include <vector>
+
+// a name passes, if there are no include-patterns or it matches at least one of them, and it matches none of the exclude-patterns
+class NameFilter {
+  std::vector<std::regex> includes;
+  std::vector<std::regex> excludes;
+
+public:
+  void addPattern(const std::regex &pattern, bool include);
+
+  bool isEmpty() const { return this->includes.empty() && this->excludes.empty(); }
+  bool accepts(const std::string &name) const;
+};
+
+class SourceFilter {
+  NameFilter fileFilter;
+  NameFilter classFilter;
+  NameFilter selectorFilter;
+
+public:
+  // pattern has the form [file|class|selector]:pattern, the pattern is a glob (* and ?) unless it starts with regex:
+  // e.g. file:*/Pods/*, class:FB*, selector:regex:^_
+  // returns false if the pattern is invalid, errorMessage tells why
+  bool addPattern(const std::string &pattern, bool include, std::string &errorMessage);
+
+  // file-paths are matched as absolute paths
+  std::vector<std::string> filterFiles(const std::vector<std::string> &filePaths) const;
+
+  bool acceptsMethod(const std::string &className, const std::string &selector) const {
+    return this->classFilter.accepts(className) && this->selectorFilter.accepts(selector);
+  }
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__SourceFilter__) */
@@ -0,0 +1,97 @@
+//
+//  SourceRangeResolver.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#ifndef __XCodeBreakpointGenerator__SourceRangeResolver__
+#define __XCodeBreakpointGenerator__SourceRangeResolver__
+
+#include <atomic>
+#include <ostream>
+
+#include "clang/Basic/SourceManager.h"
+
+#include "Breakpoint.h"
+
+inline FullSourceRange createSourceRange(clang::SourceLocation start, clang::SourceLocation end, clang::SourceManager &sourceManager) {
+  FullSourceRange sourceRange;
+
+  sourceRange.startingLineNumber = sourceManager.getSpellingLineNumber(start);
+  sourceRange.endingLineNumber = sourceManager.getSpellingLineNumber(end);
+  sourceRange.startingColumnNumber = sourceManager.getSpellingColumnNumber(start);
+  sourceRange.endingColumnNumber = sourceManager.getSpellingColumnNumber(end);
+  sourceRange.filePath = sourceManager.getFilename(sourceManager.getSpellingLoc(start));
+
+  return sourceRange;
+}
+
+enum LocationPolicy { SpellingLocation, ExpansionLocation, SkipMacroLocation };
+
+// decides where the breakpoint for a statement that was written within a macro is placed:
+// at the spelling-location, which is the macro-definition, so the breakpoint is hit by every expansion of the macro in the whole project,
+// at the expansion-location, which is the place the macro is used at, or nowhere at all
+class SourceRangeResolver {
+  LocationPolicy policy;
+  std::atomic<unsigned long> locationsWithinMacros;
+
+public:
+  SourceRangeResolver(LocationPolicy policy) : policy(policy), locationsWithinMacros(0) {}
+
+  // returns false if no breakpoint should be generated for S
+  // a location that is resolved multiple times, like the body of a method, is only counted for the summary if countsLocation is true
+  template <typename T> bool resolve(const T *S, clang::SourceManager &sourceManager, FullSourceRange &sourceRange, bool countsLocation = true) {
+    auto start = S->getLocStart();
+    auto end = S->getLocEnd();
+
+    // a statement only comes from a macro if it starts within the definition of one. return YES; merely ends within a macro, and a statement
+    // within an argument of a macro is written where the macro is used. Both are placed where they were written
+    if (!start.isMacroID() || sourceManager.isMacroArgExpansion(start)) {
+      sourceRange = createSourceRange(sourceManager.getFileLoc(start), sourceManager.getFileLoc(end), sourceManager);
+      return true;
+    }
+
+    auto spellingRange = createSourceRange(start, end, sourceManager);
+    auto expansionRange = createSourceRange(sourceManager.getExpansionLoc(start), sourceManager.getExpansionRange(end).second, sourceManager);
+    // only the locations whose breakpoint is moved or dropped by the policy are counted for the summary
+    bool isMoved = spellingRange.filePath != expansionRange.filePath || spellingRange.startingLineNumber != expansionRange.startingLineNumber;
+    if (countsLocation && (isMoved || this->policy == SkipMacroLocation)) {
+      ++this->locationsWithinMacros;
+    }
+
+    switch (this->policy) {
+    case SpellingLocation:
+      sourceRange = spellingRange;
+      return true;
+    case ExpansionLocation:
+      sourceRange = expansionRange;
+      return true;
+    case SkipMacroLocation:
+      return false;
+    }
+    return false;
+  }
+
+  void printSummary(std::ostream &output) const {
+    if (this->locationsWithinMacros == 0) {
+      return;
+    }
+    output << this->locationsWithinMacros.load() << " locations were within macros, ";
+    switch (this->policy) {
+    case SpellingLocation:
+      output << "their breakpoints were placed within the macro-definitions";
+      break;
+    case ExpansionLocation:
+      output << "their breakpoints were moved to the expansion of the macro";
+      break;
+    case SkipMacroLocation:
+      output << "no breakpoints were generated for them";
+      break;
+    }
+    output << std::endl;
+  }
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__SourceRangeResolver__) */
@@ -0,0 +1,294 @@
+//
+//  TracePasses.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "TracePasses.h"
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Tooling/Tooling.h"
+
+using namespace clang;
+using namespace ast_matchers;
+
+// the macros for custom matchers refer to internal:: without qualification, so they have to be used within ast_matchers
+namespace clang {
+namespace ast_matchers {
+
+// restricts the matched methods to the ones whose class and selector pass the --include- and --exclude-patterns
+// the methods of categories are matched with the name of the class they extend
+AST_MATCHER_P(ObjCMethodDecl, isAcceptedBy, const SourceFilter *, sourceFilter) {
+  auto classInterface = Node.getClassInterface();
+  return classInterface && sourceFilter->acceptsMethod(classInterface->getNameAsString(), Node.getSelector().getAsString());
+}
+
+} // namespace ast_matchers
+} // namespace clang
+
+namespace {
+
+const char *const decrementIndentationString = "expr if($ignoreBreakpointAtMethodEnd == false) { (void)[$indentationString setString:[$indentationString "
+                                               "substringToIndex:(int)(float)fmax($indentationString.length-4, 0)]]; }";
+
+// with --timestamps, every log-message starts with this prefix, followed by the mach_absolute_time() of the hit and the mach-thread-id of the
+// calling thread. The messages can be analysed by the TraceLogAnalyzer, which expects exactly this format
+const char *const tracePrefix = "XBG ";
+const char *const timestampAndThreadString = "@(unsigned long long)mach_absolute_time()@ @(unsigned int)pthread_mach_thread_np((void *)pthread_self())@ ";
+
+std::vector<std::pair<std::string, std::string>> formatScannedParameters(const LogValueFormatter &logValueFormatter, const ScannedMethod &method) {
+  std::vector<std::pair<std::string, std::string>> parameters;
+  for (size_t i = 0; i < method.parameterNames.size(); ++i) {
+    auto &name = method.parameterNames[i];
+    parameters.push_back(std::make_pair(name, logValueFormatter.formatForTypeSpelling(name, method.parameterTypes[i])));
+  }
+  return parameters;
+}
+
+class BreakPointGeneratorForReturnStatements : public RecursiveASTVisitor<BreakPointGeneratorForReturnStatements> {
+  std::function<bool(const Stmt *S, FullSourceRange &sourceRange)> getSourceRange;
+  std::function<void(const FullSourceRange &sourceRange, const ReturnStmt *returnStmt)> generateReturnBreakpoint;
+
+public:
+  BreakPointGeneratorForReturnStatements(decltype(getSourceRange) const &getSourceRange, decltype(generateReturnBreakpoint) const &generateReturnBreakpoint)
+      : getSourceRange(getSourceRange), generateReturnBreakpoint(generateReturnBreakpoint) {}
+
+  bool VisitReturnStmt(const clang::ReturnStmt *returnStmt) {
+    FullSourceRange sourceRange;
+    if (this->getSourceRange(returnStmt, sourceRange)) {
+      this->generateReturnBreakpoint(sourceRange, returnStmt);
+    }
+
+    return true;
+  }
+};
+
+} // namespace
+
+std::string TraceContext::logMessagePrefix() const {
+  if (this->addTimestamps) {
+    return std::string(tracePrefix) + timestampAndThreadString + "@$indentationString.UTF8String@";
+  }
+  return "@$indentationString.UTF8String@";
+}
+
+std::string TraceContext::generateReturnMessage(unsigned long startingLineNumber, const std::string &methodName,
+                                                const std::string &formattedValue) const {
+  std::stringstream logMessage;
+  logMessage << logMessagePrefix() << "returning from method " << methodName << " (line " << startingLineNumber << ")";
+  if (!formattedValue.empty()) {
+    logMessage << ", value: " << formattedValue;
+  }
+  logMessage << "\"\n";
+  return logMessage.str();
+}
+
+TracePass::TracePass(TraceContext &context) : context(context) {}
+
+void TracePass::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath) {
+  // the reference-counts of the matchers are not atomic, so every MatchFinder gets its own instead of a copy of a shared one
+  finder.addMatcher(objcMethod(isDefinition(), isInMainFile(), isAcceptedBy(&this->context.sourceFilter)).bind("method"), this);
+}
+
+void TracePass::run(const MatchFinder::MatchResult &Result) {
+  auto method = Result.Nodes.getDeclAs<ObjCMethodDecl>("method");
+  if (method->getBody()) {
+    auto methodDeclaration = std::string((method->isClassMethod() ? "+" : "-")) + "[" + method->getClassInterface()->getNameAsString() + " " +
+                             method->getSelector().getAsString() + "]";
+    traceMethod(method, methodDeclaration, *Result.Context);
+  }
+}
+
+void EntryPass::generateEntryBreakpoint(const std::string &methodDeclaration, const FullSourceRange &bodyRange,
+                                        const std::vector<std::pair<std::string, std::string>> &parameters) {
+  BreakPoint breakpoint;
+
+  breakpoint.setSourceRange(bodyRange);
+  breakpoint.setLandmarkName(methodDeclaration);
+
+  auto logMessage = this->context.logMessagePrefix() + "entering method " + methodDeclaration;
+  for (auto &parameter : parameters) {
+    logMessage += " " + parameter.first + ": " + parameter.second;
+  }
+  logMessage += "\"\n";
+
+  breakpoint.addDebugLogActionWithMessage(logMessage);
+  breakpoint.addDebugCommandActionWithCommand("expr (void)[$indentationString appendString:@&quot;    &quot;]");
+
+  this->context.writer.write(breakpoint);
+}
+
+void EntryPass::traceMethod(const ObjCMethodDecl *method, const std::string &methodDeclaration, ASTContext &astContext) {
+  // the entry-breakpoint is placed at the body
+  FullSourceRange bodyRange;
+  if (!this->context.sourceRangeResolver.resolve(method->getBody(), astContext.getSourceManager(), bodyRange)) {
+    return;
+  }
+
+  std::vector<std::pair<std::string, std::string>> parameters;
+  for (auto arg : method->parameters()) {
+    auto name = arg->getNameAsString();
+    parameters.push_back(std::make_pair(name, this->context.logValueFormatter.format(name, arg->getType())));
+  }
+  generateEntryBreakpoint(methodDeclaration, bodyRange, parameters);
+}
+
+void EntryPass::traceScannedMethod(const ScannedMethod &method) {
+  generateEntryBreakpoint(method.methodDeclaration, method.bodyRange, formatScannedParameters(this->context.logValueFormatter, method));
+}
+
+void ReturnPass::generateReturnBreakpoint(const std::string &methodDeclaration, const FullSourceRange &sourceRange, const std::string &logMessage) {
+  BreakPoint breakpoint;
+
+  breakpoint.setSourceRange(sourceRange);
+  breakpoint.setLandmarkName(methodDeclaration);
+
+  breakpoint.addDebugLogActionWithMessage(logMessage);
+  if (this->context.tracksIndentation) {
+    breakpoint.addDebugCommandActionWithCommand(decrementIndentationString);
+  }
+  breakpoint.addDebugCommandActionWithCommand("expr (void)($ignoreBreakpointAtMethodEnd = true)");
+
+  this->context.writer.write(breakpoint);
+}
+
+void ReturnPass::traceMethod(const ObjCMethodDecl *method, const std::string &methodDeclaration, ASTContext &astContext) {
+  // create breakpoints for every return-statement
+  auto sourceRangeGenerator = [this, &astContext](const Stmt *S, FullSourceRange &sourceRange) {
+    return this->context.sourceRangeResolver.resolve(S, astContext.getSourceManager(), sourceRange);
+  };
+  auto returnBreakpointGenerator = [this, &methodDeclaration, &astContext](const FullSourceRange &sourceRange, const ReturnStmt *returnStmt) {
+    auto formattedValue = this->context.logValueFormatter.formatReturnValue(returnStmt->getRetValue(), astContext);
+    generateReturnBreakpoint(methodDeclaration, sourceRange,
+                             this->context.generateReturnMessage(sourceRange.startingLineNumber, methodDeclaration, formattedValue));
+  };
+  BreakPointGeneratorForReturnStatements stmts(sourceRangeGenerator, returnBreakpointGenerator);
+  stmts.TraverseStmt(method->getBody());
+}
+
+void ReturnPass::traceScannedMethod(const ScannedMethod &method) {
+  std::map<std::string, std::string> formattedParameters;
+  for (auto &parameter : formatScannedParameters(this->context.logValueFormatter, method)) {
+    formattedParameters.insert(parameter);
+  }
+  formattedParameters["self"] = this->context.logValueFormatter.formatForTypeSpelling("self", "id");
+
+  for (auto &scannedReturn : method.returns) {
+    auto formattedValue = scannedReturn.returnValue.empty() ? std::string() : formattedParameters[scannedReturn.returnValue];
+    generateReturnBreakpoint(method.methodDeclaration, scannedReturn.sourceRange,
+                             this->context.generateReturnMessage(scannedReturn.sourceRange.startingLineNumber, method.methodDeclaration, formattedValue));
+  }
+}
+
+void MethodEndPass::generateMethodEndBreakpoint(const std::string &methodDeclaration, FullSourceRange sourceRange) {
+  BreakPoint breakpointAtMethodEnd;
+
+  // the breakpoint has to appear at the end of the body
+  sourceRange.startingLineNumber = sourceRange.endingLineNumber;
+  sourceRange.endingColumnNumber = 1;
+  sourceRange.startingColumnNumber = 1;
+  breakpointAtMethodEnd.setSourceRange(sourceRange);
+  breakpointAtMethodEnd.setLandmarkName(methodDeclaration);
+
+  breakpointAtMethodEnd.setCondition("$ignoreBreakpointAtMethodEnd ? $ignoreBreakpointAtMethodEnd = false : true");
+  breakpointAtMethodEnd.addDebugLogActionWithMessage(
+      this->context.generateReturnMessage(breakpointAtMethodEnd.getSourceRange().endingLineNumber, methodDeclaration, std::string()));
+  if (this->context.tracksIndentation) {
+    breakpointAtMethodEnd.addDebugCommandActionWithCommand(decrementIndentationString);
+  }
+  this->context.writer.write(breakpointAtMethodEnd);
+}
+
+void MethodEndPass::traceMethod(const ObjCMethodDecl *method, const std::string &methodDeclaration, ASTContext &astContext) {
+  // the end-breakpoint is placed at the body, like the entry-breakpoint. If the entry-pass is enabled, it has already counted the body
+  FullSourceRange bodyRange;
+  if (this->context.sourceRangeResolver.resolve(method->getBody(), astContext.getSourceManager(), bodyRange, !this->context.tracksIndentation)) {
+    generateMethodEndBreakpoint(methodDeclaration, bodyRange);
+  }
+}
+
+void MethodEndPass::traceScannedMethod(const ScannedMethod &method) { generateMethodEndBreakpoint(method.methodDeclaration, method.bodyRange); }
+
+MainInitialiserPass::MainInitialiserPass(BreakpointWriter &writer, SourceRangeResolver &sourceRangeResolver, bool addTimestamps)
+    : writer(writer), sourceRangeResolver(sourceRangeResolver), addTimestamps(addTimestamps), mainFileRegex(".*main\\.(m|mm|c|cpp)$") {}
+
+void MainInitialiserPass::setMainFile(const std::string &mainFilePath) { this->mainFilePath = tooling::getAbsolutePath(mainFilePath); }
+
+bool MainInitialiserPass::isMainFile(const std::string &sourceFilePath) const {
+  if (!this->mainFilePath.empty()) {
+    return tooling::getAbsolutePath(sourceFilePath) == this->mainFilePath;
+  }
+  return std::regex_match(sourceFilePath, this->mainFileRegex);
+}
+
+bool MainInitialiserPass::needsUnrequestedFile(const std::string &sourceFilePath) const { return isMainFile(sourceFilePath); }
+
+void MainInitialiserPass::registerMatchers(MatchFinder &finder, const std::string &sourceFilePath) {
+  if (isMainFile(sourceFilePath)) {
+    // only the definition, a main-file may declare the main-method before
+    finder.addMatcher(functionDecl(hasName("main"), isDefinition(), isInMainFile()).bind("mainMethod"), this);
+  }
+}
+
+void MainInitialiserPass::run(const MatchFinder::MatchResult &Result) {
+  auto mainMethod = Result.Nodes.getDeclAs<FunctionDecl>("mainMethod");
+
+  // set an initial breakpoint to initiate the indentation-variable
+  // TODO the indentation-variable should be atomic to be thread-safe
+  if (mainMethod) {
+    FullSourceRange sourceRange;
+    if (!this->sourceRangeResolver.resolve(mainMethod, Result.Context->getSourceManager(), sourceRange)) {
+      return;
+    }
+
+    BreakPoint indentationVariableInitialiser;
+
+    indentationVariableInitialiser.setSourceRange(sourceRange);
+    indentationVariableInitialiser.setLandmarkName("main");
+
+    indentationVariableInitialiser.addDebugCommandActionWithCommand("expr NSMutableString *$indentationString= [@&quot;&quot; mutableCopy]");
+    indentationVariableInitialiser.addDebugCommandActionWithCommand("expr BOOL $ignoreBreakpointAtMethodEnd= false");
+
+    // the timestamps are given in mach-ticks, the analyzer needs the timebase to convert them into nanoseconds
+    if (this->addTimestamps) {
+      indentationVariableInitialiser.addDebugCommandActionWithCommand("expr unsigned int $timebase[2]= {0, 0}");
+      indentationVariableInitialiser.addDebugCommandActionWithCommand("expr (void)mach_timebase_info((void *)$timebase)");
+      indentationVariableInitialiser.addDebugLogActionWithMessage(std::string(tracePrefix) + "timebase @$timebase[0]@/@$timebase[1]@\"\n");
+    }
+
+    std::lock_guard<std::mutex> lock(this->initialiserMutex);
+    this->initialisers.insert(std::make_pair(sourceRange.filePath, indentationVariableInitialiser));
+  }
+}
+
+int MainInitialiserPass::finish(std::ostream &report) {
+  if (this->initialisers.empty()) {
+    if (this->mainFilePath.empty()) {
+      report << "could not find the main-method within a file following the scheme main.(m|mm|c|cpp) within your compilation database or the given ASTs";
+    } else {
+      report << "could not find the main-method within " << this->mainFilePath;
+    }
+    report << " - the variables of the other breakpoints are not initialised" << std::endl;
+    return 1;
+  }
+  if (this->initialisers.size() > 1) {
+    report << "found a main-method in several files, select the one of your application with --main:" << std::endl;
+    for (auto &initialiser : this->initialisers) {
+      report << "  " << initialiser.first << std::endl;
+    }
+    report << "the variables of the other breakpoints are not initialised" << std::endl;
+    return 1;
+  }
+
+  this->writer.write(this->initialisers.begin()->second, false);
+  return 0;
+}
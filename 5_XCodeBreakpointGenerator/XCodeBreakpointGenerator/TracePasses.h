@@ -0,0 +1,153 @@
+//
+//  TracePasses.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 30/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// the passes that generate the breakpoints for tracing the methods
+// adding indentation to the breakpoint-messages
+// whenever a method is entered, the indentation is increased by 4, whenever a method left, it is decreased by 4
+// the bug from main_presentation5.cpp that logs two return-messages instead of one is solved by defining a variable in lldb named $ignoreBreakpointAtMethodEnd
+// the value of the variable (true | false) will determine if the breakpoint at the end of each method will be evaluated
+// on every breakpoint that points to a return-statement, the value will be set to true and will be reset to false in the evaluation of the condition of
+// the method-ending-breakpoints
+// the variables will be initialized in breakpoints that were set in the main-file of the project. Thus, there has to be a file in the compilation_database.json
+// that
+// matches .*main\\.(m|mm|c|cpp)$ and it has to contain the main-method, unless the main-file is given explicitly
+
+#ifndef __XCodeBreakpointGenerator__TracePasses__
+#define __XCodeBreakpointGenerator__TracePasses__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clang/AST/DeclObjC.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+#include "Breakpoint.h"
+#include "BreakpointWriter.h"
+#include "FastMethodScanner.h"
+#include "LogValueFormatter.h"
+#include "PassManager.h"
+#include "SourceFilter.h"
+#include "SourceRangeResolver.h"
+
+// everything the passes for the entry-, return- and method-end-breakpoints share
+struct TraceContext {
+  BreakpointWriter &writer;
+  SourceRangeResolver &sourceRangeResolver;
+  const LogValueFormatter &logValueFormatter;
+  const SourceFilter &sourceFilter;
+  bool addTimestamps;
+  // the indentation is only decreased when leaving a method if it was increased when entering it, which is done by the entry-pass
+  // the entry-pass also counts the bodies within macros, the method-end-pass only does so without it
+  bool tracksIndentation;
+
+  TraceContext(BreakpointWriter &writer, SourceRangeResolver &sourceRangeResolver, const LogValueFormatter &logValueFormatter,
+               const SourceFilter &sourceFilter, bool addTimestamps, bool tracksIndentation)
+      : writer(writer), sourceRangeResolver(sourceRangeResolver), logValueFormatter(logValueFormatter), sourceFilter(sourceFilter),
+        addTimestamps(addTimestamps), tracksIndentation(tracksIndentation) {}
+
+  std::string logMessagePrefix() const;
+
+  // formattedValue is the part of the message that prints the value, as created by the LogValueFormatter
+  std::string generateReturnMessage(unsigned long startingLineNumber, const std::string &methodName, const std::string &formattedValue) const;
+};
+
+// a pass that generates breakpoints for every method-definition within the main-files that passes the SourceFilter
+// the methods can come from the AST or from the FastMethodScanner
+class TracePass : public Pass, public clang::ast_matchers::MatchFinder::MatchCallback {
+protected:
+  TraceContext &context;
+
+  // only called for methods with a body
+  virtual void traceMethod(const clang::ObjCMethodDecl *method, const std::string &methodDeclaration, clang::ASTContext &astContext) = 0;
+
+public:
+  TracePass(TraceContext &context);
+
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) override;
+  virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
+
+  virtual void traceScannedMethod(const ScannedMethod &method) = 0;
+};
+
+// logs the parameters and increases the indentation when a method is entered
+class EntryPass : public TracePass {
+  void generateEntryBreakpoint(const std::string &methodDeclaration, const FullSourceRange &bodyRange,
+                               const std::vector<std::pair<std::string, std::string>> &parameters);
+
+protected:
+  virtual void traceMethod(const clang::ObjCMethodDecl *method, const std::string &methodDeclaration, clang::ASTContext &astContext) override;
+
+public:
+  EntryPass(TraceContext &context) : TracePass(context) {}
+
+  virtual const char *getName() const override { return "entry"; }
+  virtual void traceScannedMethod(const ScannedMethod &method) override;
+};
+
+// logs the return-value at every return-statement
+class ReturnPass : public TracePass {
+  void generateReturnBreakpoint(const std::string &methodDeclaration, const FullSourceRange &sourceRange, const std::string &logMessage);
+
+protected:
+  virtual void traceMethod(const clang::ObjCMethodDecl *method, const std::string &methodDeclaration, clang::ASTContext &astContext) override;
+
+public:
+  ReturnPass(TraceContext &context) : TracePass(context) {}
+
+  virtual const char *getName() const override { return "return"; }
+  virtual void traceScannedMethod(const ScannedMethod &method) override;
+};
+
+// logs leaving a method at the end of its body, unless a breakpoint at a return-statement was hit before
+class MethodEndPass : public TracePass {
+  void generateMethodEndBreakpoint(const std::string &methodDeclaration, FullSourceRange sourceRange);
+
+protected:
+  virtual void traceMethod(const clang::ObjCMethodDecl *method, const std::string &methodDeclaration, clang::ASTContext &astContext) override;
+
+public:
+  MethodEndPass(TraceContext &context) : TracePass(context) {}
+
+  virtual const char *getName() const override { return "method-end"; }
+  virtual void traceScannedMethod(const ScannedMethod &method) override;
+};
+
+// initialises the variables of lldb the other breakpoints use within the main-method
+// a workspace may contain several main-files, so the initialiser is only written once all files were matched and exactly one main-method was found
+class MainInitialiserPass : public Pass, public clang::ast_matchers::MatchFinder::MatchCallback {
+  BreakpointWriter &writer;
+  SourceRangeResolver &sourceRangeResolver;
+  bool addTimestamps;
+  std::regex mainFileRegex;
+  std::string mainFilePath;
+
+  // the initialisers by the file of their main-method, the same main-file may be compiled by several compile-commands
+  std::map<std::string, BreakPoint> initialisers;
+  std::mutex initialiserMutex;
+
+  bool isMainFile(const std::string &sourceFilePath) const;
+
+public:
+  MainInitialiserPass(BreakpointWriter &writer, SourceRangeResolver &sourceRangeResolver, bool addTimestamps = false);
+
+  // only the main-method within the given file is used instead of the ones of all files following the scheme main.(m|mm|c|cpp)
+  void setMainFile(const std::string &mainFilePath);
+
+  virtual const char *getName() const override { return "main"; }
+  virtual bool needsUnrequestedFile(const std::string &sourceFilePath) const override;
+  virtual void registerMatchers(clang::ast_matchers::MatchFinder &finder, const std::string &sourceFilePath) override;
+  virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
+  virtual int finish(std::ostream &report) override;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__TracePasses__) */
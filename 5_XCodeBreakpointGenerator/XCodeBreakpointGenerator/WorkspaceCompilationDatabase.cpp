@@ -0,0 +1,55 @@
+//
+//  WorkspaceCompilationDatabase.cpp
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 28/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+#include "WorkspaceCompilationDatabase.h"
+
+#include <set>
+
+#include "clang/Tooling/JSONCompilationDatabase.h"
+
+using namespace clang::tooling;
+
+bool WorkspaceCompilationDatabase::addDatabase(const std::string &filePath, std::string &errorMessage) {
+  std::unique_ptr<CompilationDatabase> database(JSONCompilationDatabase::loadFromFile(filePath, errorMessage));
+  if (!database) {
+    return false;
+  }
+  this->databases.push_back(std::move(database));
+  return true;
+}
+
+std::vector<CompileCommand> WorkspaceCompilationDatabase::getCompileCommands(llvm::StringRef filePath) const {
+  std::vector<CompileCommand> compileCommands;
+  for (auto &database : this->databases) {
+    auto commands = database->getCompileCommands(filePath);
+    compileCommands.insert(compileCommands.end(), commands.begin(), commands.end());
+  }
+  return compileCommands;
+}
+
+std::vector<std::string> WorkspaceCompilationDatabase::getAllFiles() const {
+  std::vector<std::string> files;
+  std::set<std::string> seenFiles;
+  for (auto &database : this->databases) {
+    for (auto &file : database->getAllFiles()) {
+      if (seenFiles.insert(file).second) {
+        files.push_back(file);
+      }
+    }
+  }
+  return files;
+}
+
+std::vector<CompileCommand> WorkspaceCompilationDatabase::getAllCompileCommands() const {
+  std::vector<CompileCommand> compileCommands;
+  for (auto &database : this->databases) {
+    auto commands = database->getAllCompileCommands();
+    compileCommands.insert(compileCommands.end(), commands.begin(), commands.end());
+  }
+  return compileCommands;
+}
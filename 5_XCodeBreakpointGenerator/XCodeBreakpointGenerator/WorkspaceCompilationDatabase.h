@@ -0,0 +1,34 @@
+//
+//  WorkspaceCompilationDatabase.h
+//  XCodeBreakpointGenerator
+//
+//  Created by Hendrik von Prince on 28/10/14.
+//  Copyright (c) 2014 Hendrik von Prince. All rights reserved.
+//
+
+// combines the compile_commands.json of multiple projects of a workspace into a single compilation-database,
+// so they can be processed in one run instead of starting the tool once for every project
+
+#ifndef __XCodeBreakpointGenerator__WorkspaceCompilationDatabase__
+#define __XCodeBreakpointGenerator__WorkspaceCompilationDatabase__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/CompilationDatabase.h"
+
+class WorkspaceCompilationDatabase : public clang::tooling::CompilationDatabase {
+  std::vector<std::unique_ptr<clang::tooling::CompilationDatabase>> databases;
+
+public:
+  // returns false if the file can't be loaded, errorMessage tells why
+  bool addDatabase(const std::string &filePath, std::string &errorMessage);
+
+  // a file that is part of multiple projects gets the compile-commands of all of them
+  virtual std::vector<clang::tooling::CompileCommand> getCompileCommands(llvm::StringRef filePath) const override;
+  virtual std::vector<std::string> getAllFiles() const override;
+  virtual std::vector<clang::tooling::CompileCommand> getAllCompileCommands() const override;
+};
+
+#endif /* defined(__XCodeBreakpointGenerator__WorkspaceCompilationDatabase__) */
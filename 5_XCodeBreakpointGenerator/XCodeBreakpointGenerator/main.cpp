@@ -7,9 +7,12 @@
 //
 
 #include <iostream>
+#include <map>
 #include <regex>
+#include <set>
 
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
@@ -28,226 +31,315 @@
 #include "clang/ASTMatchers/ASTMatchersInternal.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 
+#include "BatchQuery.h"
 #include "Breakpoint.h"
-
-// adding indentation to the breakpoint-messages
-// whenever a method is entered, the indentation is increased by 4, whenever a method left, it is decreased by 4
-// the bug from main_presentation5.cpp that logs two return-messages instead of one is solved by defining a variable in lldb named $ignoreBreakpointAtMethodEnd
-// the value of the variable (true | false) will determine if the breakpoint at the end of each method will be evaluated
-// on every breakpoint that points to a return-statement, the value will be set to true and will be reset to false in the evaluation of the condition of
-// the method-ending-breakpoints
-// the variables will be initialized in breakpoints that were set in the main-file of the project. Thus, there has to be a file in the compilation_database.json
-// that
-// matches .*main\\.(m|mm|c|cpp)$ and it has to contain the main-method
-
-const char *const decrementIndentationString = "expr if($ignoreBreakpointAtMethodEnd == false) { (void)[$indentationString setString:[$indentationString "
-                                               "substringToIndex:(int)(float)fmax($indentationString.length-4, 0)]]; }";
+#include "BreakpointWriter.h"
+#include "CallGraphPass.h"
+#include "FastMethodScanner.h"
+#include "LogValueFormatter.h"
+#include "ParallelTool.h"
+#include "PassManager.h"
+#include "PerformanceChecker.h"
+#include "SharedFileSystem.h"
+#include "SourceFilter.h"
+#include "SourceRangeResolver.h"
+#include "TracePasses.h"
+#include "WorkspaceCompilationDatabase.h"
+
+// the generator is a set of passes that all run within a single parse of every file, see PassManager.h
+// the breakpoints for tracing the methods are generated by the passes of TracePasses.h, the main_presentation<x>.cpp-files show how they evolved
 
 using namespace clang;
 using namespace tooling;
 using namespace ast_matchers;
 
-template <typename T> FullSourceRange createSourceRangeForStmt(const T *S, SourceManager &sourceManager) {
-  FullSourceRange sourceRange;
-
-  sourceRange.startingLineNumber = sourceManager.getSpellingLineNumber(S->getLocStart());
-  sourceRange.endingLineNumber = sourceManager.getSpellingLineNumber(S->getLocEnd());
-  sourceRange.startingColumnNumber = sourceManager.getSpellingColumnNumber(S->getLocStart());
-  sourceRange.endingColumnNumber = sourceManager.getSpellingColumnNumber(S->getLocEnd());
-  sourceRange.filePath = sourceManager.getFilename(sourceManager.getSpellingLoc(S->getLocStart()));
-
-  return sourceRange;
-}
-
-class BreakPointGenerator : public ast_matchers::MatchFinder::MatchCallback {
-  std::set<BreakPoint> breakpoints;
-
-  class BreakPointGeneratorForReturnStatements : public RecursiveASTVisitor<BreakPointGeneratorForReturnStatements> {
-    std::set<BreakPoint> &breakpoints;
-    std::function<FullSourceRange(const Stmt *S)> getSourceRange;
-    std::function<std::string(unsigned long startingLineNumber, const std::string &methodName, const ReturnStmt *returnStmt)> generateReturnMessage;
-    std::string methodName;
-    std::string filePath;
-    bool containsReturnStmt;
-
-  public:
-    BreakPointGeneratorForReturnStatements(decltype(breakpoints) &breakpoints, decltype(getSourceRange) const &getSourceRange,
-                                           decltype(generateReturnMessage) const &generateReturnMessage, decltype(methodName) const &methodName,
-                                           decltype(filePath) const &filePath)
-        : breakpoints(breakpoints), getSourceRange(getSourceRange), generateReturnMessage(generateReturnMessage), methodName(methodName), filePath(filePath),
-          containsReturnStmt(false) {}
-
-    bool VisitReturnStmt(const clang::ReturnStmt *returnStmt) {
-      this->containsReturnStmt = true;
-
-      BreakPoint breakpoint;
+enum PassKind { EntryPassKind, ReturnPassKind, MethodEndPassKind, MainPassKind, CallGraphPassKind, PerformancePassKind, QueriesPassKind };
 
-      breakpoint.setSourceRange(this->getSourceRange(returnStmt));
-      breakpoint.setLandmarkName(this->methodName);
-
-      auto logMessage = this->generateReturnMessage(breakpoint.getSourceRange().startingLineNumber, this->methodName, returnStmt);
-      breakpoint.addDebugLogActionWithMessage(logMessage);
-      breakpoint.addDebugCommandActionWithCommand(decrementIndentationString);
-      breakpoint.addDebugCommandActionWithCommand("expr (void)($ignoreBreakpointAtMethodEnd = true)");
-
-      if (this->breakpoints.insert(breakpoint).second) {
-        std::cout << breakpoint.asXML() << std::endl;
-      }
+// Apply a custom category to all command-line options so that they are the
+// only ones displayed.
+static llvm::cl::OptionCategory XCodeBreakpointGeneratorTool("XCodeBreakpointGenerator");
 
-      return true;
+static llvm::cl::opt<std::string> RootMethod("root", llvm::cl::desc("Only generate breakpoints for methods that are reachable from the given method, "
+                                                                    "either a selector (viewDidLoad) or a full declaration (-[FirstViewController viewDidLoad])"),
+                                             llvm::cl::value_desc("selector"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<std::string> MainFile("main", llvm::cl::desc("The file with the main-method of the application, needed if several files "
+                                                                 "follow the scheme main.(m|mm|c|cpp) (default: any of them)"),
+                                           llvm::cl::value_desc("file"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<int> MaxCallDepth("depth", llvm::cl::desc("Maximum number of calls between --root and a traced method (default: unlimited)"),
+                                       llvm::cl::value_desc("N"), llvm::cl::init(-1), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<std::string> QueryFile("queries", llvm::cl::desc("Don't generate breakpoints, run every clang-query-expression of the file "
+                                                                     "over the given files instead and report the matches per query"),
+                                            llvm::cl::value_desc("file"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<bool> CheckPerformance("check-performance", llvm::cl::desc("Don't generate breakpoints, report expensive code within loops "
+                                                                             "(logging, boxing, autoreleased objects, string-formatting, property-chains) "
+                                                                             "like compiler-warnings instead. Exits with 1 if there are any findings"),
+                                            llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<unsigned> Jobs("j", llvm::cl::desc("Number of files that are processed in parallel (default: number of cores)"), llvm::cl::init(0),
+                                    llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<bool> FastMode("fast", llvm::cl::desc("Find the methods with the raw lexer instead of parsing the files, files that contain macros "
+                                                           "or anything else the lexer can't resolve are still parsed"),
+                                    llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<LocationPolicy> LocationPolicyOption(
+    "location-policy", llvm::cl::desc("Where to place breakpoints for statements that were written within macros:"),
+    llvm::cl::values(clEnumValN(SpellingLocation, "spelling", "within the macro-definition, hit by every use of the macro"),
+                     clEnumValN(ExpansionLocation, "expansion", "where the macro is used (default)"),
+                     clEnumValN(SkipMacroLocation, "skip-macros", "don't generate a breakpoint"), clEnumValEnd),
+    llvm::cl::init(ExpansionLocation), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<unsigned> MaxRSS("max-rss", llvm::cl::desc("Don't start parsing another file while the resident memory is above the given "
+                                                                "number of megabytes (default: no limit)"),
+                                      llvm::cl::value_desc("MB"), llvm::cl::init(0), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<unsigned> MaxCache("max-cache", llvm::cl::desc("Drop the least recently used files of the cache of --workspace and --unsaved "
+                                                                    "once it exceeds the given number of megabytes (default: a quarter of --max-rss)"),
+                                        llvm::cl::value_desc("MB"), llvm::cl::init(0), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<bool> LoadASTFiles("ast", llvm::cl::desc("The given files are ASTs that were serialized by the build (clang -emit-ast), "
+                                                            "they are loaded instead of parsing the sources again"),
+                                        llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::opt<bool> AddTimestamps("timestamps", llvm::cl::desc("Add the time and the thread-id to every log-message, see TraceLogAnalyzer"),
+                                         llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<std::string> DescribedClasses("describe-classes",
+                                                    llvm::cl::desc("Objects of these classes (and their subclasses) are logged by their description, "
+                                                                   "all other objects by their class and address (default: NSString,NSNumber)"),
+                                                    llvm::cl::value_desc("class,..."), llvm::cl::CommaSeparated,
+                                                    llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<std::string> Workspace("workspace", llvm::cl::desc("Use the compile-commands of all given compilation-databases instead of a "
+                                                                        "single one, the files are read only once for all of them"),
+                                             llvm::cl::value_desc("compile_commands.json,..."), llvm::cl::CommaSeparated,
+                                             llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<std::string> UnsavedFiles("unsaved", llvm::cl::desc("Use the contents of the second file instead of the ones of the first file, "
+                                                                          "e.g. for unsaved buffers of an editor"),
+                                                llvm::cl::value_desc("file=contents"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<std::string> IncludePatterns("include", llvm::cl::desc("Only process the files, classes or selectors that match one of the "
+                                                                           "patterns, e.g. file:*/Sources/* or class:FB* or selector:regex:^load"),
+                                                   llvm::cl::value_desc("file|class|selector:pattern"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<std::string> ExcludePatterns("exclude", llvm::cl::desc("Don't process the files, classes or selectors that match one of the "
+                                                                           "patterns, e.g. file:*/Pods/* or selector:regex:^_"),
+                                                   llvm::cl::value_desc("file|class|selector:pattern"), llvm::cl::cat(XCodeBreakpointGeneratorTool));
+static llvm::cl::list<PassKind> Passes(
+    "passes", llvm::cl::desc("The passes that run over every file (default: entry,return,method-end,main):"),
+    llvm::cl::values(clEnumValN(EntryPassKind, "entry", "log entering a method and its parameters"),
+                     clEnumValN(ReturnPassKind, "return", "log the return-statements and their values"),
+                     clEnumValN(MethodEndPassKind, "method-end", "log leaving a method at the end of its body"),
+                     clEnumValN(MainPassKind, "main", "initialise the variables of the breakpoints within the main-method"),
+                     clEnumValN(CallGraphPassKind, "call-graph", "only keep the breakpoints of the methods reachable from --root"),
+                     clEnumValN(PerformancePassKind, "performance", "the checks of --check-performance"),
+                     clEnumValN(QueriesPassKind, "queries", "the clang-query-expressions of --queries"), clEnumValEnd),
+    llvm::cl::CommaSeparated, llvm::cl::cat(XCodeBreakpointGeneratorTool));
+
+// a directory stands for all files of the compilation-database below it, so `.` processes the whole database
+static std::vector<std::string> expandDirectories(const std::vector<std::string> &sourcePaths, const std::vector<std::string> &databaseFiles) {
+  std::vector<std::string> expandedPaths;
+  for (auto &sourcePath : sourcePaths) {
+    if (!llvm::sys::fs::is_directory(sourcePath)) {
+      expandedPaths.push_back(sourcePath);
+      continue;
     }
-  };
-
-public:
-  std::string generateReturnMessage(unsigned long startingLineNumber, const std::string &methodName, const ReturnStmt *mayBeNull) {
-    std::stringstream logMessage;
-    logMessage << "@$indentationString.UTF8String@returning from method " << methodName << " (line " << startingLineNumber << ")";
-
-    if (mayBeNull) {
-      auto returnValue = mayBeNull->getRetValue();
-      if (returnValue) {
-        if (auto declRef = dyn_cast_or_null<DeclRefExpr>(returnValue->IgnoreImpCasts())) {
-          if (declRef) {
-            logMessage << ", value: @" << declRef->getDecl()->getNameAsString() << "@";
-          }
-        }
-      }
+    auto directoryPath = getAbsolutePath(sourcePath);
+    if (directoryPath.empty() || directoryPath.back() != '/') {
+      directoryPath += '/';
     }
-    logMessage << "\"\n";
-    return logMessage.str();
-  }
-
-  virtual void run(const ast_matchers::MatchFinder::MatchResult &Result) {
-    auto method = Result.Nodes.getDeclAs<ObjCMethodDecl>("method");
-    auto body = method->getBody();
-    if (body) {
-      auto methodDeclaration = std::string((method->isClassMethod() ? "+" : "-")) + "[" + method->getClassInterface()->getNameAsString() + " " +
-                               method->getSelector().getAsString() + "]";
-      auto filePath = Result.Context->getSourceManager().getFilename(Result.Context->getSourceManager().getSpellingLoc(body->getLocStart()));
-      std::cerr << "visit " << methodDeclaration << std::endl;
-      BreakPoint breakpoint;
-
-      breakpoint.setSourceRange(createSourceRangeForStmt(body, Result.Context->getSourceManager()));
-      breakpoint.setLandmarkName(methodDeclaration);
-
-      auto logMessage = "@$indentationString.UTF8String@entering method " + methodDeclaration;
-      for (auto arg : method->parameters()) {
-        logMessage += " " + arg->getNameAsString() + ": @" + arg->getNameAsString() + "@";
-      }
-      logMessage += "\"\n";
-
-      breakpoint.addDebugLogActionWithMessage(logMessage);
-      breakpoint.addDebugCommandActionWithCommand("expr (void)[$indentationString appendString:@&quot;    &quot;]");
-
-      if (this->breakpoints.insert(breakpoint).second) {
-        std::cout << breakpoint.asXML() << std::endl;
+    for (auto &filePath : databaseFiles) {
+      if (getAbsolutePath(filePath).compare(0, directoryPath.size(), directoryPath) == 0) {
+        expandedPaths.push_back(filePath);
       }
-
-      // create breakpoints for every return-statement
-      auto sourceRangeGenerator = [&Result](const Stmt *S) { return createSourceRangeForStmt(S, Result.Context->getSourceManager()); };
-      auto messageGenerator = [this](unsigned long startingLineNumber, const std::string &methodName, const ReturnStmt *mayBeNull) {
-        return this->generateReturnMessage(startingLineNumber, methodName, mayBeNull);
-      };
-      BreakPointGeneratorForReturnStatements stmts(this->breakpoints, sourceRangeGenerator, messageGenerator, methodDeclaration, filePath);
-      // this will generate the breakpoints for the return-statements and print them to stdout
-      stmts.TraverseStmt(body);
-
-      BreakPoint breakpointAtMethodEnd;
-
-      auto sourceRange = createSourceRangeForStmt(body, Result.Context->getSourceManager());
-      // the breakpoint has to appear at the end of the body
-      sourceRange.startingLineNumber = sourceRange.endingLineNumber;
-      sourceRange.endingColumnNumber = 1;
-      sourceRange.startingColumnNumber = 1;
-      breakpointAtMethodEnd.setSourceRange(sourceRange);
-      breakpointAtMethodEnd.setLandmarkName(methodDeclaration);
-
-      breakpointAtMethodEnd.setCondition("$ignoreBreakpointAtMethodEnd ? $ignoreBreakpointAtMethodEnd = false : true");
-      breakpointAtMethodEnd.addDebugLogActionWithMessage(
-          this->generateReturnMessage(breakpointAtMethodEnd.getSourceRange().endingLineNumber, methodDeclaration, nullptr));
-      breakpointAtMethodEnd.addDebugCommandActionWithCommand(decrementIndentationString);
-      if (this->breakpoints.insert(breakpointAtMethodEnd).second) {
-        std::cout << breakpointAtMethodEnd.asXML() << std::endl;
-      }
-    }
-  }
-};
-
-class MainMethodFinder : public ast_matchers::MatchFinder::MatchCallback {
-  std::string filePath;
-
-  std::shared_ptr<BreakPoint> indentationVariableInitialiser;
-
-public:
-  MainMethodFinder() {}
-
-  void setCurrentFilePath(const std::string &filePath) { this->filePath = filePath; }
-
-  virtual void run(const ast_matchers::MatchFinder::MatchResult &Result) {
-    auto mainMethod = Result.Nodes.getDeclAs<FunctionDecl>("mainMethod");
-
-    // set an initial breakpoint to initiate the indentation-variable
-    // TODO the indentation-variable should be atomic to be thread-safe
-    if (mainMethod) {
-      assert(this->indentationVariableInitialiser.get() == nullptr &&
-             "multiple main-methods found in one or more files referenced within the compilation-database, can't proceed");
-
-      this->indentationVariableInitialiser = std::unique_ptr<BreakPoint>(new BreakPoint());
-
-      this->indentationVariableInitialiser->setSourceRange(createSourceRangeForStmt(mainMethod, Result.Context->getSourceManager()));
-      this->indentationVariableInitialiser->setLandmarkName("main");
-
-      this->indentationVariableInitialiser->addDebugCommandActionWithCommand("expr NSMutableString *$indentationString= [@&quot;&quot; mutableCopy]");
-      this->indentationVariableInitialiser->addDebugCommandActionWithCommand("expr BOOL $ignoreBreakpointAtMethodEnd= false");
     }
   }
-
-  const decltype(indentationVariableInitialiser) getIndentationVariableInitialiser() const { return this->indentationVariableInitialiser; }
-};
-
-// Apply a custom category to all command-line options so that they are the
-// only ones displayed.
-static llvm::cl::OptionCategory XCodeBreakpointGeneratorTool("XCodeBreakpointGenerator");
+  return expandedPaths;
+}
 
 int main(int argc, const char *argv[]) {
   CommonOptionsParser OptionsParser(argc, argv, XCodeBreakpointGeneratorTool);
 
-  CompilationDatabase &db = OptionsParser.getCompilations();
+  WorkspaceCompilationDatabase workspace;
+  for (auto &databasePath : Workspace) {
+    std::string errorMessage;
+    if (!workspace.addDatabase(databasePath, errorMessage)) {
+      std::cerr << "could not load " << databasePath << ": " << errorMessage << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  CompilationDatabase &db = Workspace.empty() ? OptionsParser.getCompilations() : workspace;
+
+  // every header is read only once for all files and databases, instead of once per compile-command
+  // it is only used when it's needed, because it keeps the contents of the files in memory
+  std::unique_ptr<SharedFileSystem> sharedFileSystem;
+  if (!Workspace.empty() || !UnsavedFiles.empty()) {
+    sharedFileSystem.reset(new SharedFileSystem());
+    // the cache counts toward --max-rss, so by default it may only take a part of it, the rest is left for the ASTs
+    uint64_t maxCache = MaxCache ? MaxCache : MaxRSS / 4;
+    sharedFileSystem->setMaxCachedBytes(maxCache * 1024 * 1024);
+  }
+  for (auto &unsavedFile : UnsavedFiles) {
+    auto separator = unsavedFile.find('=');
+    if (separator == std::string::npos) {
+      std::cerr << "--unsaved expects file=contents, got " << unsavedFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!sharedFileSystem->addUnsavedFile(unsavedFile.substr(0, separator), unsavedFile.substr(separator + 1))) {
+      return EXIT_FAILURE;
+    }
+  }
 
-  // try to find the main-file to find the
-  // entry-point to initialise the indentation-variable and the ignoreBreakpointAtMethodEnd-variable
-  MainMethodFinder mainMethodFinder;
-  for (auto filePath : db.getAllFiles()) {
-    if (std::regex_match(filePath, std::regex(".*main\\.(m|mm|c|cpp)$"))) {
-      DeclarationMatcher mainMethodMatcher = functionDecl(hasName("main")).bind("mainMethod");
+  // the patterns are compiled once, the files are filtered before anything is parsed
+  SourceFilter sourceFilter;
+  for (auto patterns : {std::make_pair(&IncludePatterns, true), std::make_pair(&ExcludePatterns, false)}) {
+    for (auto &pattern : *patterns.first) {
+      std::string errorMessage;
+      if (!sourceFilter.addPattern(pattern, patterns.second, errorMessage)) {
+        std::cerr << errorMessage << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  // the passes that need unrequested files, like the call-graph and the main-pass, only get the database-files that pass the patterns as well
+  auto databaseFiles = sourceFilter.filterFiles(db.getAllFiles());
+  auto sourcePaths = sourceFilter.filterFiles(expandDirectories(OptionsParser.getSourcePathList(), databaseFiles));
+  if (sourcePaths.empty()) {
+    std::cerr << "all given files were excluded by the --include- and --exclude-patterns, or the given directories contain no files of the "
+                 "compilation-database" << std::endl;
+    return EXIT_FAILURE;
+  }
 
-      ClangTool tool(db, filePath);
-      MatchFinder finder;
-      finder.addMatcher(mainMethodMatcher, &mainMethodFinder);
+  // without --passes, the breakpoints for tracing are generated, unless only the queries or the checks were asked for
+  std::set<PassKind> selectedPasses(Passes.begin(), Passes.end());
+  if (selectedPasses.empty() && QueryFile.empty() && !CheckPerformance) {
+    selectedPasses = {EntryPassKind, ReturnPassKind, MethodEndPassKind, MainPassKind};
+  }
+  if (!RootMethod.empty()) {
+    selectedPasses.insert(CallGraphPassKind);
+  }
+  if (CheckPerformance) {
+    selectedPasses.insert(PerformancePassKind);
+  }
+  if (!QueryFile.empty()) {
+    selectedPasses.insert(QueriesPassKind);
+  }
+  if (selectedPasses.count(CallGraphPassKind) && RootMethod.empty()) {
+    std::cerr << "the call-graph-pass needs the method to start from, given by --root" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (selectedPasses.count(QueriesPassKind) && QueryFile.empty()) {
+    std::cerr << "the queries-pass needs the file with the queries, given by --queries" << std::endl;
+    return EXIT_FAILURE;
+  }
 
-      mainMethodFinder.setCurrentFilePath(filePath);
+  // -description of these classes is cheap and doesn't have side-effects
+  std::vector<std::string> describedClasses = {"NSString", "NSNumber"};
+  if (DescribedClasses.getNumOccurrences() > 0) {
+    describedClasses.assign(DescribedClasses.begin(), DescribedClasses.end());
+  }
+  LogValueFormatter logValueFormatter(describedClasses);
+
+  // all passes write into the same writer, which filters out the duplicates and holds back the breakpoints for the call-graph
+  SourceRangeResolver sourceRangeResolver(LocationPolicyOption);
+  BreakpointWriter writer(std::cout, selectedPasses.count(CallGraphPassKind) > 0);
+  TraceContext traceContext(writer, sourceRangeResolver, logValueFormatter, sourceFilter, AddTimestamps, selectedPasses.count(EntryPassKind) > 0);
+
+  EntryPass entryPass(traceContext);
+  ReturnPass returnPass(traceContext);
+  MethodEndPass methodEndPass(traceContext);
+  MainInitialiserPass mainInitialiserPass(writer, sourceRangeResolver, AddTimestamps);
+  if (!MainFile.empty()) {
+    mainInitialiserPass.setMainFile(MainFile);
+  }
+  CallGraphPass callGraphPass(writer, RootMethod, MaxCallDepth);
+  PerformanceChecker performanceChecker;
+  BatchQuery batchQuery;
+  if (selectedPasses.count(QueriesPassKind) && !batchQuery.parseQueryFile(QueryFile)) {
+    return EXIT_FAILURE;
+  }
 
-      tool.run(newFrontendActionFactory(&finder).get());
+  std::map<PassKind, Pass *> availablePasses = {{EntryPassKind, &entryPass},
+                                                {ReturnPassKind, &returnPass},
+                                                {MethodEndPassKind, &methodEndPass},
+                                                {MainPassKind, &mainInitialiserPass},
+                                                {CallGraphPassKind, &callGraphPass},
+                                                {PerformancePassKind, &performanceChecker},
+                                                {QueriesPassKind, &batchQuery}};
+  std::map<PassKind, TracePass *> availableTracePasses = {
+      {EntryPassKind, &entryPass}, {ReturnPassKind, &returnPass}, {MethodEndPassKind, &methodEndPass}};
+
+  // the passes are run and finished in the order of PassKind, so the call-graph is finished after the breakpoints were collected
+  PassManager passManager;
+  std::vector<TracePass *> tracePasses;
+  bool needsAST = false;
+  for (auto kind : selectedPasses) {
+    passManager.addPass(availablePasses[kind]);
+    if (availableTracePasses.count(kind)) {
+      tracePasses.push_back(availableTracePasses[kind]);
+    } else if (kind != MainPassKind) {
+      needsAST = true;
     }
   }
+  // the reports of the checks and queries don't mix with the breakpoints, they are written to stderr if there are any breakpoints
+  bool writesBreakpoints = !tracePasses.empty() || selectedPasses.count(MainPassKind);
+  std::ostream &report = writesBreakpoints ? std::cerr : std::cout;
 
-  auto indentationVariableInitialiser = mainMethodFinder.getIndentationVariableInitialiser();
-  if (indentationVariableInitialiser.get() == nullptr) {
-    std::cerr << "could not find the main-method within a file following the scheme main.(m|mm|c|cpp) within your compilation database - can't proceed"
-              << std::endl;
+  if (FastMode && selectedPasses.count(CallGraphPassKind)) {
+    std::cerr << "--fast can't be combined with --root, the call-graph needs the AST" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (FastMode && LoadASTFiles) {
+    std::cerr << "--fast can't be combined with --ast, the ASTs are loaded anyway" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (FastMode && needsAST) {
+    std::cerr << "--fast only works with the entry-, return-, method-end- and main-passes, the others need the AST" << std::endl;
     return EXIT_FAILURE;
   }
 
-  std::cout << indentationVariableInitialiser->asXML() << std::endl;
-
-  ClangTool tool(db, OptionsParser.getSourcePathList());
-  tool.appendArgumentsAdjuster(new ClangSyntaxOnlyAdjuster());
+  auto requestedFiles = sourcePaths;
+  if (FastMode) {
+    // only the files the lexer gives up on are parsed
+    FastMethodScanner scanner(sharedFileSystem.get());
+    std::vector<std::string> filesToParse;
+    for (auto &filePath : sourcePaths) {
+      std::vector<ScannedMethod> methods;
+      std::string reasonForFallback;
+      if (!scanner.scanFile(filePath, methods, reasonForFallback)) {
+        std::cerr << "parsing " << filePath << ": " << reasonForFallback << std::endl;
+        filesToParse.push_back(filePath);
+        continue;
+      }
+      for (auto &method : methods) {
+        if (sourceFilter.acceptsMethod(method.className, method.selector)) {
+          for (auto tracePass : tracePasses) {
+            tracePass->traceScannedMethod(method);
+          }
+        }
+      }
+    }
+    // the main-file is still parsed for the main-pass, even if the lexer could handle it
+    requestedFiles = filesToParse;
+  }
 
-  DeclarationMatcher methodMatcher = objcMethod(isDefinition(), isInMainFile()).bind("method");
+  // with --ast, every pass is given every AST, the main-pass picks the one of the main-file
+  if (LoadASTFiles && selectedPasses.count(CallGraphPassKind)) {
+    std::cerr << "warning: with --ast, the call-graph only contains the calls within the given ASTs, methods that are only reachable through "
+                 "other files are missed" << std::endl;
+  }
+  // the main-file given by --main is parsed even if it's excluded, the patterns select what is traced, not where the application starts
+  if (!MainFile.empty() && selectedPasses.count(MainPassKind)) {
+    auto absoluteMainFile = getAbsolutePath(MainFile);
+    bool isDatabaseFile = false;
+    for (auto &filePath : databaseFiles) {
+      isDatabaseFile = isDatabaseFile || getAbsolutePath(filePath) == absoluteMainFile;
+    }
+    if (!isDatabaseFile) {
+      databaseFiles.push_back(MainFile);
+    }
+  }
+  auto files = LoadASTFiles ? requestedFiles : passManager.collectFiles(requestedFiles, databaseFiles);
+  ParallelTool tool(db, files, Jobs);
+  tool.setMaxResidentMemory((uint64_t)MaxRSS * 1024 * 1024);
+  tool.setSharedFileSystem(sharedFileSystem.get());
+
+  // the breakpoints are written as soon as a method was matched, so nothing of a file is kept after it was processed
+  int result = LoadASTFiles ? passManager.runOnASTs(tool) : passManager.run(tool, requestedFiles);
+  if (passManager.finish(report) != 0) {
+    result = EXIT_FAILURE;
+  }
 
-  BreakPointGenerator Printer;
-  MatchFinder Finder;
-  Finder.addMatcher(methodMatcher, &Printer);
+  sourceRangeResolver.printSummary(std::cerr);
 
-  return tool.run(newFrontendActionFactory(&Finder).get());
+  return result;
 }